@@ -4,6 +4,7 @@
 #include "glm_include.hpp"
 #include "timeline.hpp"
 #include <map>
+#include <vector>
 
 namespace dmsc {
 
@@ -57,6 +58,13 @@ struct Animation {
 
     std::pair<bool, AnimationDetails> getSatelliteAnimation(const size_t satellite_idx, const float t) const;
     std::pair<bool, AnimationDetails> getISLAnimation(const size_t isl_idx, const float t) const;
+
+    /**
+     * @brief Moves the ISL animations to new ISL indices (see PhysicalInstance::removeInvalidISL()). Animations of
+     * removed ISLs (~0u) are dropped.
+     * @param isl_map new index of every old ISL index
+     */
+    void remapISLs(const std::vector<uint32_t>& isl_map);
 };
 
 } // namespace dmsc
@@ -8,6 +8,17 @@
 
 namespace dmsc {
 
+/**
+ * @brief Visibility of an edge that is known without sweeping over the time (see InterSatelliteLink::getVisibility()).
+ */
+enum class EdgeVisibility {
+    ALWAYS, // never blocked by the central mass
+    NEVER,  // always blocked by the central mass
+    VARIES, // unknown; the visibility windows have to be calculated
+};
+
+// ------------------------------------------------------------------------------------------------
+
 /**
  * @brief Bidirectional intersatellite link between two satellites A and B.
  */
@@ -17,10 +28,44 @@ class InterSatelliteLink {
     const Satellite* v2;
     uint32_t v1_idx;
     uint32_t v2_idx;
-    float period;   // [sec] time until satellite constellations repeat
+    float period;   // [sec] time until satellite constellations repeat (or the planning horizon, if not periodic)
+    bool periodic;  // false, if the constellation doesn't repeat within the planning horizon
+    float horizon;  // [sec] the edge is only evaluated before this time (INFINITY, if the period is exact)
     CentralMass cm; // properties of the central mass
+    EdgeVisibility visibility;
+
+    EdgeVisibility classifyVisibility() const; // analytic classification (see getVisibility())
 
   public:
+    static constexpr float DEFAULT_HORIZON = 86400.f;     // [sec] default planning horizon (one day)
+    static constexpr double HYPERPERIOD_TOLERANCE = 1e-4; // [revolutions] max. phase drift per period
+    static constexpr float CLASSIFICATION_MARGIN = 1.f;   // [km] min. |clearance| of edges that are classified
+
+    /**
+     * @brief Iterates over the time in uniform steps and tracks the positions of both satellites (see
+     * Satellite::Stepper). Sweeps that check the edge every step should use this instead of isBlocked(time).
+     */
+    class Stepper {
+      public:
+        Stepper(const InterSatelliteLink& link, const Tick t0, const Tick dt)
+            : link(&link)
+            , sat1(link.getV1().stepper(t0, dt))
+            , sat2(link.getV2().stepper(t0, dt)) {}
+
+        void step() {
+            sat1.step();
+            sat2.step();
+        }
+
+        Tick time() const { return sat1.time(); }
+        bool isBlocked() const { return link->isBlocked(sat1.position(), sat2.position()); }
+
+      private:
+        const InterSatelliteLink* link;
+        Satellite::Stepper sat1;
+        Satellite::Stepper sat2;
+    };
+
     /**
      * @brief Bidirectional intersatellite link between two satellites A and B.
      *
@@ -28,15 +73,60 @@ class InterSatelliteLink {
      * @param v1_idx index of satellite A in the given vector reference
      * @param v2_idx index of satellite B in the given vector reference
      * @param cm information about the central mass
+     * @param horizon [sec] Planning horizon. Satellites at the same altitude have the same period, so the edge repeats
+     * exactly with it. Otherwise, the edge is only considered within [0, horizon).
+     * @param hyperperiod If set, edges between satellites at different altitudes repeat with the common period of both
+     * satellites (see math::findHyperperiod()), if there is one within the horizon. This period is only approximate
+     * (see HYPERPERIOD_TOLERANCE), so the edge is still only considered within [0, horizon).
      */
     InterSatelliteLink(const uint32_t& v1_idx, const uint32_t& v2_idx, const std::vector<Satellite>& satellites,
-                       const CentralMass cm);
+                       const CentralMass cm, const float horizon = DEFAULT_HORIZON, const bool hyperperiod = false);
 
     /**
-     * @brief Returns true, if the edge is blocked at the given time.
+     * @brief Returns true, if the edge is blocked at the given time (i.e. the line of sight between both satellites
+     * intersects the central mass).
      */
     bool isBlocked(const float time) const;
 
+    /**
+     * @brief Returns true, if the edge is blocked when its satellites are located at the given positions.
+     *
+     * @param sat1 & sat2 Positions of satellite A and B (e.g. calculated by a ConstellationPropagator).
+     */
+    bool isBlocked(const glm::vec3& sat1, const glm::vec3& sat2) const;
+
+    /**
+     * @brief Returns the distance between the line of sight of both satellites and the surface of the central mass at
+     * the given time. The result is negative, if the edge is blocked. In contrast to isBlocked(), the clearance is a
+     * continuous function of the time, so the boundaries of visibility windows can be found as its roots.
+     * @param time [sec]
+     * @return [km] clearance
+     */
+    float clearance(const float time) const;
+
+    /**
+     * @brief Same as clearance(time), but for the given satellite positions.
+     */
+    float clearance(const glm::vec3& sat1, const glm::vec3& sat2) const;
+
+    /**
+     * @brief Same as clearance(time), but in double precision (see Satellite::cartesian_coordinates()). Used to locate
+     * the boundaries of visibility windows.
+     */
+    double clearance(const double time) const;
+
+    /**
+     * @brief Same as clearance(time), but for the given satellite positions in double precision.
+     */
+    double clearance(const glm::dvec3& sat1, const glm::dvec3& sat2) const;
+
+    /**
+     * @brief Returns a stepper that checks this edge in uniform time steps.
+     * @param t0 start time
+     * @param dt time step
+     */
+    Stepper stepper(const Tick t0, const Tick dt) const { return Stepper(*this, t0, dt); }
+
     /**
      * @brief Returns true, if there is enough time for both satellites to face each other at the given time.
      *
@@ -46,6 +136,22 @@ class InterSatelliteLink {
      */
     bool canAlign(const TimelineEvent<glm::vec3>& sat1, const TimelineEvent<glm::vec3>& sat2, const float t) const;
 
+    /**
+     * @brief Returns the time that is left after both satellites turned to face each other at the given time (the
+     * smaller value of both satellites). The satellites can align, iff the result is >= 0 (see canAlign()). In contrast
+     * to canAlign(), the slack is a continuous function of the time, so the earliest alignment can be found as its
+     * root.
+     * @return [sec] slack
+     */
+    float alignmentSlack(const TimelineEvent<glm::vec3>& sat1, const TimelineEvent<glm::vec3>& sat2,
+                         const float t) const;
+
+    /**
+     * @brief Same as alignmentSlack(), but in double precision (see Satellite::cartesian_coordinates()).
+     */
+    double alignmentSlack(const TimelineEvent<glm::vec3>& sat1, const TimelineEvent<glm::vec3>& sat2,
+                          const double t) const;
+
     /**
      * @brief Calculate the directions for both satellites to face each other. Because both satellites have to face each
      * other, the direction of satellite A is the negative direction of satellite B.
@@ -54,8 +160,24 @@ class InterSatelliteLink {
      */
     glm::vec3 getOrientation(const float time) const;
 
+    /**
+     * @brief Same as getOrientation(), but in double precision.
+     */
+    glm::dvec3 getOrientation(const double time) const;
+
+    /**
+     * @brief Returns EdgeVisibility::ALWAYS or NEVER, if the visibility can be proven without sampling the time. This
+     * is the case for satellites on the same circular orbit: they keep their angular distance, so the line of sight
+     * always has the same clearance. Edges whose clearance is within CLASSIFICATION_MARGIN of zero are not classified,
+     * because a sweep might see them flicker due to rounding errors.
+     */
+    EdgeVisibility getVisibility() const { return visibility; }
+
     // GETTER
     float getPeriod() const { return period; }
+    Tick getPeriodTicks() const { return toTicks(period); }
+    bool isPeriodic() const { return periodic; }
+    Tick getHorizonTicks() const { return toTicks(horizon); }
     const Satellite& getV1() const { return *v1; }
     const Satellite& getV2() const { return *v2; }
     uint32_t getV1Idx() const { return v1_idx; }
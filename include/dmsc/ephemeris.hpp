@@ -0,0 +1,58 @@
+#ifndef DMSC_EPHEMERIS_H
+#define DMSC_EPHEMERIS_H
+
+#include "dmsc/glm_include.hpp"
+#include "satellite.hpp"
+#include <vector>
+
+namespace dmsc {
+
+/**
+ * @brief Piecewise Chebyshev approximation of the position of a satellite over one period.
+ *
+ * The period is split into segments of equal length. For each segment and axis, a Chebyshev polynomial is fitted to the
+ * exact positions once. Afterwards a position can be evaluated with a few multiply-adds (Clenshaw recurrence) instead
+ * of solving Kepler's equation.
+ */
+class ChebyshevEphemeris {
+  public:
+    ChebyshevEphemeris() = default;
+
+    /**
+     * @brief Fits the ephemeris to the given satellite. The number of segments is doubled until the approximation
+     * error (checked between the interpolation nodes) is below the given tolerance.
+     *
+     * @param tolerance [km] max. distance between the exact and the approximated position (the exact Kepler solver only
+     * converges to about 1e-5 rad, so tolerances far below 0.1 km don't improve the result)
+     * @param degree degree of each polynomial
+     */
+    ChebyshevEphemeris(const Satellite& satellite, const float tolerance = 0.1f, const uint32_t degree = 10);
+
+    /**
+     * @brief Returns the approximated position of the satellite at the given time.
+     * @param time [sec]
+     */
+    glm::vec3 evaluate(const double time) const;
+
+    // GETTER
+    uint32_t getSegmentCount() const { return segments; }
+    uint32_t getDegree() const { return degree; }
+    float getMaxError() const { return max_error; } // [km] max. error found while fitting
+
+  private:
+    static constexpr uint32_t MAX_SEGMENTS = 4096;
+
+    double period = 0.0;         // [sec]
+    double segment_length = 0.0; // [sec]
+    uint32_t segments = 0;
+    uint32_t degree = 0;
+    float max_error = 0.f;
+    std::vector<float> coefficients; // [segment][axis][degree + 1]
+
+    void fit(const Satellite& satellite);
+    float measureError(const Satellite& satellite) const;
+};
+
+} // namespace dmsc
+
+#endif
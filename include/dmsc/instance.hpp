@@ -125,15 +125,33 @@ class PhysicalInstance {
 
     /**
      * @brief Removes all intersatellite links that will never be visible. I.e. if an ISL is always blocked by the
-     * central mass, it will be removed.
+     * central mass, it will be removed. The remaining ISLs keep their order, but their indices change.
+     * @return Index map: new index of the ISL with the given old index (~0u, if the ISL was removed). Use it to update
+     * indices that refer to the old ISLs (see Animation::remapISLs() and remapEdges()).
      */
-    void removeInvalidISL();
+    std::vector<uint32_t> removeInvalidISL();
+
+    /**
+     * @brief Sets the propagation mode of all satellites (see Satellite::setPropagationMode()). The orbits don't
+     * change, only the way positions are calculated. Solvers should be created after the mode has been set.
+     */
+    void setPropagationMode(const PropagationMode mode);
+
+    /**
+     * @brief Sets the planning horizon [sec] and recreates all ISLs. Satellites at different altitudes usually don't
+     * repeat their constellation within a reasonable time, so their ISLs are only evaluated within [0, horizon) (see
+     * InterSatelliteLink::isPeriodic()). If hyperperiod is set, these ISLs repeat with the approximate common period of
+     * both satellites within the horizon instead. Solvers should be created after the horizon has been set.
+     */
+    void setPlanningHorizon(const float horizon, const bool hyperperiod = false);
 
     // ISLs are stored in an adjacency list; scheduled communications are stored in this vector
     std::vector<ScheduledCommunication> scheduled_communications;
 
     // GETTER
     float getRadiusCentralMass() const { return cm.radius_central_mass; }
+    float getPlanningHorizon() const { return planning_horizon; }
+    bool usesHyperperiod() const { return hyperperiod; }
     const std::vector<Satellite>& getSatellites() const { return satellites; }
     const std::vector<InterSatelliteLink>& getISLs() const { return intersatellite_links; }
     const AdjacencyList& getAdjacencyMatrix() const { return adjacency_list; }
@@ -145,6 +163,8 @@ class PhysicalInstance {
     std::vector<InterSatelliteLink> intersatellite_links;
     AdjacencyList adjacency_list = AdjacencyList(0, AdjacencyList::Item(~0u, ~0u));
     CentralMass cm;
+    float planning_horizon = InterSatelliteLink::DEFAULT_HORIZON; // [sec]
+    bool hyperperiod = false; // common periods of ISLs at different altitudes (see setPlanningHorizon())
     enum FileReadingMode { READ_INIT, READ_ORBIT, READ_EDGE }; // order must match blocks in file-format
 
     void buildAdjacencyMatrix();
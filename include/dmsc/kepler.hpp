@@ -0,0 +1,93 @@
+#ifndef DMSC_KEPLER_H
+#define DMSC_KEPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dmsc {
+
+/**
+ * @brief Solves Kepler's equation M = E - e * sin(E) for one eccentricity.
+ *
+ * A lookup table of E(M) is created once and provides the starting value for every solve. Afterwards a fixed number of
+ * Halley steps is performed. There is no data-dependent early exit, so the batch solve is a plain loop the compiler is
+ * able to vectorize and every solve takes the same time. The number of steps is chosen on construction: it is the
+ * smallest number of steps for which the error on a dense grid of mean anomalies is below the requested tolerance, plus
+ * one step as safety margin (halley's method converges cubically, so the error between the grid points vanishes).
+ */
+class KeplerSolver {
+  public:
+    KeplerSolver() = default;
+
+    /**
+     * @param eccentricity has to be in range [0, 1)
+     * @param tolerance [rad] max. error of the eccentric anomaly (for eccentricities close to 1, the accuracy near the
+     * periapsis is limited by single precision; see getMaxError())
+     */
+    KeplerSolver(const float eccentricity, const float tolerance = 1e-5f);
+
+    /**
+     * @brief Returns the eccentric anomaly for the given mean anomaly.
+     * @param mean_anomaly [rad] has to be in range [0, 2pi)
+     */
+    float solve(const float mean_anomaly) const;
+
+    /**
+     * @brief Solves Kepler's equation for n mean anomalies at once. Input and output may be the same array.
+     * @param mean_anomaly [rad] n values in range [0, 2pi)
+     * @param eccentric_anomaly [rad] output for n values
+     */
+    void solve(const float* mean_anomaly, float* eccentric_anomaly, const size_t n) const;
+
+    /**
+     * @brief Same as solve(), but in double precision. The halley steps are repeated until they converge, so this is
+     * meant for single positions that have to be accurate rather than fast.
+     * @param mean_anomaly [rad] has to be in range [0, 2pi)
+     */
+    double solve(const double mean_anomaly) const;
+
+    /**
+     * @brief Converts an eccentric anomaly into the true anomaly.
+     * @return [rad] true anomaly in range (-pi, pi]
+     */
+    float trueAnomaly(const float eccentric_anomaly) const;
+
+    /**
+     * @brief Same as trueAnomaly(), but in double precision.
+     */
+    double trueAnomaly(const double eccentric_anomaly) const;
+
+    // GETTER
+    float getEccentricity() const { return eccentricity; }
+    uint32_t getIterations() const { return iterations; }
+    float getMaxError() const { return max_error; } // [rad] max. error found on the verification grid
+
+  private:
+    static constexpr uint32_t TABLE_SIZE = 256;    // number of intervals of the lookup table
+    static constexpr uint32_t MAX_ITERATIONS = 8;  // upper limit for the number of halley steps
+    static constexpr uint32_t CHECKS_PER_ENTRY = 8; // density of the verification grid
+
+    float eccentricity = 0.f;
+    float half_angle_factor = 1.f; // sqrt((1 + e) / (1 - e))
+    uint32_t iterations = 0;
+    float max_error = 0.f;
+    std::vector<float> table; // E(M) for M = i * 2pi / TABLE_SIZE (TABLE_SIZE + 1 entries)
+
+    float startingValue(const float mean_anomaly) const;
+
+    /**
+     * @brief Mean anomaly of the j-th point of the verification grid.
+     */
+    static float checkAnomaly(const uint32_t j);
+
+    /**
+     * @brief Returns the max. error on the verification grid.
+     * @param reference exact eccentric anomalies of the points of the verification grid
+     */
+    float measureError(const std::vector<double>& reference) const;
+};
+
+} // namespace dmsc
+
+#endif
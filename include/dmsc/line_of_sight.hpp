@@ -0,0 +1,37 @@
+#ifndef DMSC_LINE_OF_SIGHT_H
+#define DMSC_LINE_OF_SIGHT_H
+
+#include "propagator.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace dmsc {
+
+/**
+ * @brief Result of a batch line of sight check: bit (i % 64) of word (i / 64) is set, if line i is visible.
+ */
+using VisibilityMask = std::vector<uint64_t>;
+
+/**
+ * @brief Checks n lines of sight at once. Line i connects (x1[i], y1[i], z1[i]) and (x2[i], y2[i], z2[i]) and is
+ * visible, if it does not intersect the central mass (sphere with the given radius at the origin). This is the same
+ * test as InterSatelliteLink::isBlocked(), but it only uses squared distances (no square roots or divisions) and
+ * processes 64 lines per output word in branch-free loops, so the compiler is able to vectorize it.
+ *
+ * @param visible output; must have space for (n + 63) / 64 words
+ */
+void checkLineOfSight(const float* x1, const float* y1, const float* z1, const float* x2, const float* y2,
+                      const float* z2, const size_t n, const float radius, uint64_t* visible);
+
+/**
+ * @brief Checks the lines of sight between the satellites from[i] and to[i] for one time sample of a position buffer
+ * (i.e. the position of satellite k is positions[offset + k]).
+ *
+ * @param visible output; will be resized to (from.size() + 63) / 64 words
+ */
+void checkLineOfSight(const PositionBuffer& positions, const size_t offset, const std::vector<uint32_t>& from,
+                      const std::vector<uint32_t>& to, const float radius, VisibilityMask& visible);
+
+} // namespace dmsc
+
+#endif
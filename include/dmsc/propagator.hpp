@@ -0,0 +1,110 @@
+#ifndef DMSC_PROPAGATOR_H
+#define DMSC_PROPAGATOR_H
+
+#include "dmsc/glm_include.hpp"
+#include "ephemeris.hpp"
+#include "kepler.hpp"
+#include "satellite.hpp"
+#include <vector>
+
+namespace dmsc {
+
+/**
+ * @brief Positions of several satellites stored as structure of arrays (one array per axis).
+ */
+struct PositionBuffer {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    void resize(const size_t size) {
+        x.resize(size);
+        y.resize(size);
+        z.resize(size);
+    }
+
+    size_t size() const { return x.size(); }
+    glm::vec3 operator[](const size_t idx) const { return glm::vec3(x[idx], y[idx], z[idx]); }
+};
+
+// ------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Calculates the positions of all satellites of a constellation at once.
+ *
+ * Satellites that share an Orbit (e.g. the planes of a Walker constellation created by a PhysicalInstance) are
+ * propagated together: the orbit is propagated once and the positions of its satellites are obtained by rotating the
+ * result by their phase within the orbital plane. So the trigonometric functions and Kepler's equation (see
+ * KeplerSolver) are evaluated once per orbit and the remaining work per satellite is a few multiply-adds. All data is
+ * stored as structure of arrays and processed in branch-free loops, so the compiler is able to vectorize them.
+ * Satellites in PropagationMode::EPHEMERIS evaluate their ephemeris instead.
+ */
+class ConstellationPropagator {
+  public:
+    ConstellationPropagator() = default;
+
+    /**
+     * @brief Copies the orbital elements of the given satellites. The order of the satellites is kept, i.e. position i
+     * in the output buffer belongs to satellites[i].
+     */
+    ConstellationPropagator(const std::vector<Satellite>& satellites);
+
+    /**
+     * @brief Same as above, but only for a subset of the satellites: position i in the output buffer belongs to
+     * satellites[subset[i]].
+     */
+    ConstellationPropagator(const std::vector<Satellite>& satellites, const std::vector<uint32_t>& subset);
+
+    /**
+     * @brief Calculates the positions of all satellites at the given time.
+     * @param time [sec]
+     * @param positions Output buffer; will be resized to the number of satellites.
+     */
+    void propagate(const double time, PositionBuffer& positions) const;
+
+    /**
+     * @brief Calculates the positions of all satellites for a block of equidistant time samples.
+     * The position of satellite i at time t0 + s * dt is stored at index s * size() + i.
+     * @param t0 [sec] time of the first sample
+     * @param dt [sec] time between two samples
+     * @param samples number of time samples
+     * @param positions Output buffer; will be resized to samples * size().
+     */
+    void propagate(const double t0, const double dt, const size_t samples, PositionBuffer& positions) const;
+
+    /**
+     * @brief Returns the number of satellites.
+     */
+    size_t size() const { return satellite_idx.size(); }
+
+    /**
+     * @brief Returns the number of distinct orbits (i.e. the number of orbits that are actually propagated).
+     */
+    size_t orbitCount() const { return mean_angular_speed.size(); }
+
+  private:
+    // orbital elements (one entry per orbit)
+    std::vector<double> mean_angular_speed; // [rad/sec]
+    std::vector<float> eccentricity;
+    std::vector<float> semi_latus_rectum; // [km]
+    std::vector<float> px, py, pz;        // unit vector pointing to the periapsis
+    std::vector<float> qx, qy, qz;        // unit vector perpendicular to p in the orbital plane
+
+    // elliptic orbits need Kepler's equation to find the true anomaly
+    std::vector<uint32_t> elliptic_idx;
+    std::vector<KeplerSolver> kepler_solvers;
+
+    // satellites ordered by orbit; the satellites of orbit i are stored in [orbit_begin[i], orbit_begin[i + 1])
+    std::vector<uint32_t> orbit_begin;
+    std::vector<uint32_t> satellite_idx; // index in the output buffer
+    std::vector<float> cos_phase;        // phase of the satellite within its orbital plane
+    std::vector<float> sin_phase;
+
+    // elliptic orbits in ephemeris mode overwrite their position with the approximation
+    std::vector<uint32_t> ephemeris_idx;
+    std::vector<ChebyshevEphemeris> ephemerides;
+};
+
+} // namespace dmsc
+
+#endif
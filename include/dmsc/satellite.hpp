@@ -3,9 +3,12 @@
 
 #define _USE_MATH_DEFINES
 #include "dmsc/glm_include.hpp"
+#include "kepler.hpp"
+#include "tick.hpp"
 #include <exception>
 #include <iostream>
 #include <math.h>
+#include <memory>
 
 namespace dmsc {
 
@@ -53,23 +56,137 @@ struct StateVector {
 
 // ------------------------------------------------------------------------------------------------
 
-class Satellite {
+/**
+ * @brief Shape of an orbit. Parabolic and hyperbolic orbits are not supported.
+ */
+enum class OrbitClass {
+    CIRCULAR, // eccentricity = 0
+    ELLIPTIC, // eccentricity in (0, 1)
+};
+
+// ------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Determines how the position of a satellite is calculated.
+ */
+enum class PropagationMode {
+    EXACT,     // solve Kepler's equation for every position
+    EPHEMERIS, // evaluate a precomputed Chebyshev approximation (elliptic orbits only; see ChebyshevEphemeris)
+};
+
+class ChebyshevEphemeris;
+
+// ------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Everything that is derived from the shape and location of an orbit around the central mass. All satellites on
+ * the same orbit (see StateVector::isSameOrbit()) differ only in their initial true anomaly, so they can share one
+ * Orbit object.
+ */
+class Orbit {
+  public:
+    /**
+     * @brief Validates the orbit and calculates all values that don't depend on the time. Orbits with an eccentricity
+     * outside of [0, 1) are rejected. The initial true anomaly of the state vector is ignored.
+     */
+    Orbit(const StateVector& sv, const CentralMass& cm);
+
+    // GETTER
+    float getPeriod() const { return period; }
+    float getMeanAngularSpeed() const { return mean_angular_speed; }
+    float getSemiMajorAxis() const { return semi_major_axis; }
+    float getSemiLatusRectum() const { return semi_latus_rectum; }
+    float getMaxSpeed() const { return max_speed; }
+    float getEccentricity() const { return eccentricity; }
+    OrbitClass getOrbitClass() const { return orbit_class; }
+    const glm::vec3& getPerifocalP() const { return perifocal_p; }
+    const glm::vec3& getPerifocalQ() const { return perifocal_q; }
+    const KeplerSolver& getKeplerSolver() const { return kepler; } // only valid for elliptic orbits
+
   private:
-    StateVector sv;           // parameters that describe the satellite position and its orbit around the central mass
-    CentralMass cm;           // parameters of the central mass
     float period;             // [sec] time required for one revolution around the central mass
     float mean_angular_speed; // [rad / sec]
     float semi_major_axis;    // [km] semi-major axis of the ellipse that describes the orbit of the satellite
+    float semi_latus_rectum;  // [km] distance to the central mass at a true anomaly of 90 deg
+    float max_speed;          // [km / sec] orbital speed at the periapsis
+    float eccentricity;
+    OrbitClass orbit_class; // determines which propagation kernel is used
+    glm::vec3 perifocal_p;  // unit vector pointing from the central mass to the periapsis
+    glm::vec3 perifocal_q;  // unit vector in the orbital plane; 90 deg ahead of perifocal_p
+    KeplerSolver kepler;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+class Satellite {
+  private:
+    StateVector sv; // parameters that describe the satellite position and its orbit around the central mass
+    CentralMass cm; // parameters of the central mass
+    std::shared_ptr<const Orbit> orbit; // may be shared with other satellites on the same orbit
+    PropagationMode propagation_mode = PropagationMode::EXACT;
+    std::shared_ptr<const ChebyshevEphemeris> ephemeris; // only set for elliptic orbits in ephemeris mode
+
+    float circularAnomaly(const float time) const; // true anomaly for circular orbits
+    float ellipticAnomaly(const float time) const; // true anomaly for elliptic orbits (solves Kepler's equation)
 
   public:
     /**
-     * @brief Constructs a new satellite from a given StateVector.
+     * @brief Iterates over the positions of a satellite in uniform time steps (t0, t0 + dt, t0 + 2dt, ...). The time
+     * is given in ticks, so the sweep never gets stuck for large time values.
+     *
+     * For circular orbits the anomaly advances by a constant angle per step, so the position is advanced by a
+     * precomputed 2x2 rotation instead of evaluating trigonometric functions. To stop the rotation from drifting, it
+     * is re-anchored to the exact anomaly every REANCHOR_INTERVAL steps. Elliptic orbits are evaluated every step (see
+     * PropagationMode).
+     */
+    class Stepper {
+      public:
+        Stepper(const Satellite& satellite, const Tick t0, const Tick dt);
+
+        /**
+         * @brief Advances the satellite by one time step.
+         */
+        void step();
+
+        /**
+         * @brief Returns the current time.
+         */
+        Tick time() const { return t0 + dt * steps; }
+
+        /**
+         * @brief Returns the position of the satellite at the current time.
+         */
+        const glm::vec3& position() const { return pos; }
+
+      private:
+        static constexpr Tick REANCHOR_INTERVAL = 1024;
+        const Satellite* satellite;
+        Tick t0;                         // start time
+        Tick dt;                         // time step
+        Tick steps = 0;                  // number of steps performed
+        double cos_step, sin_step;       // rotation per step (circular orbits only)
+        double cos_anomaly, sin_anomaly; // current anomaly (circular orbits only)
+        glm::vec3 pos;                   // position at the current time
+
+        void anchor(); // calculates the exact position at the current time
+        void updateCircularPosition();
+    };
+
+    /**
+     * @brief Constructs a new satellite from a given StateVector. The orbit is validated and everything that does not
+     * depend on the time is calculated once. Orbits with an eccentricity outside of [0, 1) are rejected.
      *
      * @param initial_true_anomaly [rad]
      * @param gravitational_parameter [km^3 / s^2]
      */
     Satellite(const StateVector sv, const CentralMass& cm);
 
+    /**
+     * @brief Constructs a new satellite on an existing orbit. The given orbit must have been created from a state
+     * vector that describes the same orbit (see StateVector::isSameOrbit()) and the same central mass.
+     */
+    Satellite(const StateVector sv, const CentralMass& cm, std::shared_ptr<const Orbit> orbit);
+
     /**
      * @brief Transforms a satellite position into 3D cartesian coordinates.
      * z-axis: vernal point; y-axis: up-direction; x-axis: normal
@@ -86,22 +203,79 @@ class Satellite {
      */
     glm::vec3 cartesian_coordinates(const float time) const;
 
+    /**
+     * @brief Same as cartesian_coordinates(), but the time and the position are in double precision. A float time
+     * can't resolve less than a millisecond after a few hours, so this is used to locate events precisely (e.g. the
+     * boundaries of visibility windows). Elliptic orbits are always propagated exactly (see PropagationMode).
+     * @param time [sec] Determines satellite position in orbit.
+     * @return (x, y, z) coordinates
+     */
+    glm::dvec3 cartesian_coordinates(const double time) const;
+
+    /**
+     * @brief Same as cartesian_coordinates(), but specialized for one orbit class at compile time. The given orbit
+     * class must match getOrbitClass().
+     * @param time [sec] Determines satellite position in orbit.
+     * @return (x, y, z) coordinates
+     */
+    template <OrbitClass C>
+    glm::vec3 position(const float time) const;
+
+    /**
+     * @brief Returns a stepper that iterates over the positions of this satellite in uniform time steps.
+     * @param t0 start time
+     * @param dt time step
+     */
+    Stepper stepper(const Tick t0, const Tick dt) const { return Stepper(*this, t0, dt); }
+
+    /**
+     * @brief Returns the true anomaly of the satellite at the given time.
+     * @param time [sec]
+     * @return [rad] true anomaly (not necessarily in range [0, 2pi))
+     */
+    float trueAnomaly(const float time) const;
+
+    /**
+     * @brief Switches between exact and ephemeris propagation. In ephemeris mode, elliptic orbits are fitted once by a
+     * ChebyshevEphemeris and all following positions are evaluated from it. Circular orbits don't need Kepler's
+     * equation and are always propagated exactly.
+     */
+    void setPropagationMode(const PropagationMode mode);
+
     // GETTER
-    float getPeriod() const { return period; }
-    float getSemiMajorAxis() const { return semi_major_axis; }
+    const Orbit& getOrbit() const { return *orbit; }
+    const std::shared_ptr<const Orbit>& getSharedOrbit() const { return orbit; }
+    float getPeriod() const { return orbit->getPeriod(); }
+    float getMeanAngularSpeed() const { return orbit->getMeanAngularSpeed(); }
+    float getSemiMajorAxis() const { return orbit->getSemiMajorAxis(); }
+    float getSemiLatusRectum() const { return orbit->getSemiLatusRectum(); }
+    float getMaxSpeed() const { return orbit->getMaxSpeed(); }
+    OrbitClass getOrbitClass() const { return orbit->getOrbitClass(); }
+    const glm::vec3& getPerifocalP() const { return orbit->getPerifocalP(); }
+    const glm::vec3& getPerifocalQ() const { return orbit->getPerifocalQ(); }
     float getEccentricity() const { return sv.eccentricity; }
     float getRotationSpeed() const { return sv.rotation_speed; }
     float getTrueAnomaly() const { return sv.initial_true_anomaly; }
+    float getInitialMeanAnomaly() const { // [rad] phase at t = 0 (elliptic orbits start at the periapsis)
+        return orbit->getOrbitClass() == OrbitClass::CIRCULAR ? sv.initial_true_anomaly : 0.f;
+    }
     float getRaan() const { return sv.raan; }
     float getArgumentPeriapsis() const { return sv.argument_periapsis; }
     float getInclination() const { return sv.inclination; }
     float getHeightPerigee() const { return sv.height_perigee; }
     float getConeAngle() const { return sv.cone_angle; }
+    PropagationMode getPropagationMode() const { return propagation_mode; }
+    const ChebyshevEphemeris* getEphemeris() const { return ephemeris.get(); } // nullptr, if propagated exactly
 
     // SETTER
     void setRotationSpeed(float speed) { sv.rotation_speed = speed; };
 };
 
+template <>
+glm::vec3 Satellite::position<OrbitClass::CIRCULAR>(const float time) const;
+template <>
+glm::vec3 Satellite::position<OrbitClass::ELLIPTIC>(const float time) const;
+
 } // namespace dmsc
 
 #endif
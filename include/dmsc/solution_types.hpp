@@ -9,6 +9,21 @@ namespace dmsc {
 /// index of an edge and the time when this edge is scanned - time in [sec]
 using ScanCover = std::multimap<uint32_t, float>;
 
+/**
+ * @brief Moves the scheduled edges to new edge indices (see PhysicalInstance::removeInvalidISL()). Removed edges (~0u)
+ * are dropped.
+ * @param edge_map new index of every old edge index
+ */
+inline ScanCover remapEdges(const ScanCover& scan_cover, const std::vector<uint32_t>& edge_map) {
+    ScanCover remapped;
+    for (const auto& scan : scan_cover) {
+        if (scan.first < edge_map.size() && edge_map[scan.first] != ~0u) {
+            remapped.insert({edge_map[scan.first], scan.second});
+        }
+    }
+    return remapped;
+}
+
 // ------------------------------------------------------------------------------------------------
 
 /**
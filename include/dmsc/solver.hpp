@@ -3,60 +3,341 @@
 
 #include "instance.hpp"
 #include "satellite.hpp"
+#include "tick.hpp"
 #include "timeline.hpp"
 #include <map>
+#include <string>
+#include <vector>
 
 namespace dmsc {
 
+class ConstellationPropagator;
+
+/**
+ * @brief Determines how the visibility windows of the edges are found.
+ */
+enum class VisibilitySweep {
+    RASTER,       // check every edge once per step_size; boundaries are rounded to the raster
+    ADAPTIVE,     // same result as RASTER, but raster points that can't change the visibility are skipped (the
+                  // clearance is only used to find them; the raster points are checked like in RASTER)
+    ROOT_FINDING, // bracket the sign changes of InterSatelliteLink::clearance() and refine them with Brent's method;
+                  // windows and gaps shorter than bracket_step might be missed
+    BISECTION,    // sample the clearance every coarse_step and bisect intervals until its bounds exclude a boundary
+};
+
+/**
+ * @brief Determines how the visibility windows are stored for queries (see Solver::nextVisibility()).
+ */
+enum class VisibilityStore {
+    WINDOWS, // sorted array of windows per equivalence class; queries use a binary search
+    BITMAP,  // one bit per step_size of the period and edge; queries scan for the next set bit
+};
+
+// ------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Settings that are shared by all solvers.
+ */
+struct SolverSettings {
+    VisibilitySweep visibility_sweep = VisibilitySweep::RASTER;
+    Tick bracket_step = 10 * TICKS_PER_SECOND; // time between two clearance samples (ROOT_FINDING); windows that are
+                                               // shorter than this might be missed
+    Tick boundary_tolerance = TICKS_PER_SECOND / 10000; // max. error of window boundaries (ROOT_FINDING, BISECTION)
+    Tick coarse_step = 30 * TICKS_PER_SECOND; // time between two clearance samples (BISECTION)
+    bool lazy_cache = true; // calculate the visibility windows of an edge when they are needed for the first time; the
+                            // greedy solvers calculate the windows of their candidate edges up front instead (see
+                            // Solver::completeCache())
+    Tick cache_chunk = 3600 * TICKS_PER_SECOND; // time span that is added to the cache at once (lazy_cache) or
+                                                // calculated by one task (otherwise)
+    size_t threads = 0; // threads used to calculate the whole cache at once and to evaluate candidate edges in the
+                        // greedy solvers (0: one per hardware thread)
+    std::string cache_file; // if set, the visibility windows are loaded from / saved to this file (see createCache())
+    VisibilityStore visibility_store = VisibilityStore::WINDOWS; // BITMAP rounds up to the next raster point
+    bool communication_memo = true; // reuse results of nextCommunication() while both orientations don't change
+};
+
+// ------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Read-only view of the orientations of all satellites (indexed by satellite), see Solver::nextCommunication().
+ */
+struct OrientationView {
+    const TimelineEvent<glm::vec3>* orientations;
+
+    const TimelineEvent<glm::vec3>& operator[](const uint32_t satellite_idx) const {
+        return orientations[satellite_idx];
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+
 class Solver {
   public:
-    Solver(const PhysicalInstance& instance)
-        : instance(instance) {
+    Solver(const PhysicalInstance& instance, const SolverSettings& settings = SolverSettings())
+        : instance(instance)
+        , settings(settings) {
+        clearOrientations();
         createCache();
     };
 
   protected:
     /**
      * @brief Calculates the time (beginning at time x) when an egde can be scanned the next time.
-     * The central mass and turn costs are considered.
+     * The central mass and turn costs are considered. If the satellites can't align at the next visibility, the
+     * alignment slack (see InterSatelliteLink::alignmentSlack()) is sampled within the visibility windows. The slack
+     * changes by at most 1 + (turn rate of the line of sight) / (rotation speed) per second, so ticks are skipped while
+     * this bound proves that the slack is negative (see math::findFirstNonNegative()). The result is the first tick
+     * with a non-negative slack.
+     *
+     * So the result only depends on time_0 and the orientations of both satellites, and it is also the result for every
+     * later start time up to the result itself. So it is memoized per edge (communication_memo) until one of the
+     * orientations changes (see setOrientation()).
      * @param time_0 [sec] start time
      * @return Absolute time in [sec] for next communication possible.
      */
     float nextCommunication(const InterSatelliteLink& edge, const float time_0);
 
+    /**
+     * @brief Same as nextCommunication(), but for the given orientations and without the memo. Once the cache is
+     * complete (see completeCache()), it doesn't modify the solver and can be called from several threads at once.
+     */
+    float nextCommunication(const InterSatelliteLink& edge, const float time_0,
+                            const OrientationView orientations) const;
+
+    /**
+     * @brief Returns the memoized result of nextCommunication() for the current orientations (NAN, if there is none).
+     * Together with memoizeCommunication(), candidates can be evaluated in parallel and memoized afterwards.
+     */
+    float findMemoizedCommunication(const InterSatelliteLink& edge, const float time_0) const;
+
+    /**
+     * @brief Stores the result of nextCommunication() for the current orientations (if communication_memo is set).
+     */
+    void memoizeCommunication(const InterSatelliteLink& edge, const float time_0, const float t_result);
+
+    /**
+     * @brief Sets the orientation of a satellite and the time when it changed (see nextCommunication()).
+     */
+    void setOrientation(const uint32_t satellite_idx, const TimelineEvent<glm::vec3>& orientation);
+
+    /**
+     * @brief Returns the last known orientation of a satellite (invalid, if it wasn't set yet).
+     */
+    const TimelineEvent<glm::vec3>& getOrientation(const uint32_t satellite_idx) const {
+        return satellite_orientation[satellite_idx];
+    }
+
+    /**
+     * @brief Resets the orientations of all satellites (i.e. none of them has been part of a communication yet).
+     */
+    void clearOrientations();
+
+    /**
+     * @brief Returns a view of the current orientations of all satellites (invalidated by clearOrientations()).
+     */
+    OrientationView orientationView() const { return {satellite_orientation.data()}; }
+
+    /**
+     * @brief Calculates all visibility windows that are still missing (lazy_cache) and the bitmaps of all edges
+     * (VisibilityStore::BITMAP). Afterwards, the const queries only read the cache.
+     */
+    void completeCache();
+
+    /**
+     * @brief Same as completeCache(), but only for the given edges (ISL indices). Afterwards, the const queries of
+     * these edges only read the cache, so solvers that only query a subset of the edges keep the rest lazy.
+     */
+    void completeCache(const std::vector<uint32_t>& isl_indices);
+
     /** Returns the time when the edge is visible for next time beginning at time t0.
      * If the corresponding time slot was evalutated before - use the cached version to reduce computation
      * time.
      * @param time_0 [sec] start time
-     * @return Absolute time in [sec] for next visibility. INFINITY if the edge will never be visible.
+     * @return Absolute time in [sec] for next visibility. INFINITY if the edge will never be visible (or not within the
+     * planning horizon, if the period of the edge is not exact; see InterSatelliteLink::getHorizonTicks()).
      */
-    float nextVisibility(const InterSatelliteLink& edge, const float t0);
+    float nextVisibility(const InterSatelliteLink& edge, const float t0) const;
 
     const PhysicalInstance instance;
-    const float step_size = 1.0f; // [sec]
-    std::map<const Satellite*, TimelineEvent<glm::vec3>>
-        satellite_orientation; // Last known orientation for each satellite and the time when it changed.
+    const SolverSettings settings;
+    const Tick step_size = TICKS_PER_SECOND; // 1 sec
 
   private:
-    /** Calculates the time (beginning at time t0) when an edge is no longer interrupted by the central mass.
-     * This is done by iterating over t and check each time step if the edge is visible.
-     * @param time_0 [sec] start time
-     * @return Absolute time in [sec] for next visibility. INFINITY if the edge will never be visible.
+    /** Same as nextVisibility(), but with ticks as time base.
+     * @return TICK_INFINITY if the edge will never be visible.
      */
-    float findNextVisiblity(const InterSatelliteLink& edge, const float t0) const;
+    Tick nextVisibilityTicks(const InterSatelliteLink& edge, const Tick t0) const;
 
-    /** Calculates the time (beginning at time t0) when an edge is no longer visible.
-     * This is done by iterating over t and check each time step if the edge is visible.
-     * @param time_0 [sec] start time
-     * @return Absolute time in [sec] for end of visibility. INFINITY if the edge will never disappear.
+    /**
+     * @brief Returns the first time >= t0 when the edge is blocked (i.e. the end of the visibility window at time t0).
+     * A window that reaches the end of the period (or the planning horizon) ends there, even if the next period begins
+     * with a window.
+     * @return t0, if the edge isn't visible at time t0 (otherwise at least t0 + 1)
+     */
+    Tick nextBlockedTicks(const InterSatelliteLink& edge, const Tick t0) const;
+
+    /**
+     * @brief Returns the index of the given edge in the ISLs of the instance (~0u, if it isn't an ISL of the instance).
+     */
+    uint32_t islIndex(const InterSatelliteLink& edge) const;
+
+    /**
+     * @brief VisibilityStore::BITMAP - same as nextVisibilityTicks(), but the result is the next raster point
+     * (n * period + k * step_size) that is visible.
+     */
+    Tick findBitmapVisibility(const uint32_t isl_idx, const Tick t0) const;
+
+    /**
+     * @brief Returns the bitmap of an edge: bit k is set, if the edge is visible at time k * step_size (k * step_size <
+     * period). It is created from the windows of the equivalence class when it is needed for the first time.
+     */
+    const std::vector<uint64_t>& visibilityBitmap(const uint32_t isl_idx) const;
+
+    /** Calculates the first raster point (beginning at time t0) when an edge is no longer interrupted by the central
+     * mass. Raster points that can't be visible are skipped (see findRasterTime()).
+     * @param t0 start time
+     * @param propagator propagates the satellites of the edge (in this order)
+     * @return Absolute time for next visibility. TICK_INFINITY if the edge will never be visible.
+     */
+    Tick findNextVisiblity(const InterSatelliteLink& edge, const Tick t0,
+                           const ConstellationPropagator& propagator) const;
+
+    /** Calculates the last raster point (beginning at time t0) before an edge is no longer visible. Raster points that
+     * can't be blocked are skipped (see findRasterTime()).
+     * @param t0 start time
+     * @param propagator propagates the satellites of the edge (in this order)
+     * @return Absolute time for end of visibility. TICK_INFINITY if the edge will never disappear.
+     */
+    Tick findLastVisible(const InterSatelliteLink& edge, const Tick t0,
+                         const ConstellationPropagator& propagator) const;
+
+    /**
+     * @brief Returns the first time t0 + k * step_size (within one period) when the visibility of the edge matches the
+     * given one. The clearance is used to skip raster points: the clearance changes by at most the max. speed of the
+     * faster satellite, so its sign can't change for |clearance| / speed seconds. The remaining raster points are
+     * checked with the positions of the propagator and checkLineOfSight() like in sweepVisibilityWindows(), so the
+     * result is the same as with VisibilitySweep::RASTER.
+     * @return TICK_INFINITY if there is no such time
+     */
+    Tick findRasterTime(const InterSatelliteLink& edge, const Tick t0, const bool visible,
+                        const ConstellationPropagator& propagator) const;
+
+    /**
+     * @brief VisibilitySweep::ADAPTIVE - alternates between searching the next visible and the next blocked raster
+     * point (see findNextVisiblity() and findLastVisible()), so only the raster points that the clearance can't skip
+     * are checked.
+     */
+    std::vector<TimeWindow> findVisibilityWindowsAdaptive(const InterSatelliteLink& edge) const;
+
+    /**
+     * @brief VisibilitySweep::BISECTION - samples the clearance every coarse_step. Each interval is bisected until the
+     * clearance at its ends proves that there is no boundary inside (the clearance changes by at most the max. speed of
+     * the faster satellite) or until it is shorter than boundary_tolerance. So boundaries are found with this
+     * tolerance, and windows shorter than coarse_step are found as well.
+     */
+    std::vector<TimeWindow> findVisibilityWindowsBisection(const InterSatelliteLink& edge) const;
+
+    /**
+     * @brief Extends the visibility windows of a class up to time t_end (or the end of its period).
+     * VisibilitySweep::ADAPTIVE and BISECTION calculate the whole period at once.
+     */
+    void extendVisibilityWindows(const uint32_t class_idx, const Tick t_end) const;
+
+    /**
+     * @brief Calculates the windows of the given classes that were not sampled yet on a ThreadPool. The classes are
+     * split into groups and time slices of cache_chunk, so a single class with a long period doesn't stall the other
+     * threads. The slices are merged in the order of time afterwards, so the result doesn't depend on the number of
+     * threads.
+     */
+    void computeVisibilityWindows(const std::vector<uint32_t>& classes);
+
+    struct VisibilityClass;
+
+    /**
+     * @brief VisibilitySweep::RASTER and ROOT_FINDING - samples the given classes at t_begin + k * step <= t_end
+     * (until the end of their period). The positions of their satellites are calculated once per sample (see
+     * ConstellationPropagator) and are shared by all edges, so a sample costs one propagation per satellite instead of
+     * two per edge. The window boundaries are the raster points (refine = false) or the sign changes of the clearance
+     * found with Brent's method (refine = true). Classes that were not sampled yet begin at t_begin; all other classes
+     * must have been sampled up to t_begin - step.
      */
-    float findLastVisible(const InterSatelliteLink& edge, const float t0) const;
+    void sweepVisibilityWindows(const std::vector<VisibilityClass*>& classes, const Tick t_begin, const Tick t_end,
+                                const Tick step, const bool refine) const;
 
+    /**
+     * @brief Returns the first time >= t (within one period) when the edges of the class are visible (without offset).
+     * The windows of the class are extended by cache_chunk until the answer is known.
+     * @return TICK_INFINITY if there is no such time
+     */
+    Tick findCachedVisibility(const uint32_t class_idx, const Tick t) const;
+
+    /**
+     * @brief Returns the end of the window of the class that is active at time t (without offset). The windows of the
+     * class are extended by cache_chunk until the window is closed.
+     */
+    Tick findCachedWindowEnd(const uint32_t class_idx, const Tick t) const;
+
+    /**
+     * @brief Returns a hash of everything the visibility windows depend on: the central mass, the satellites, the ISLs
+     * and the settings of the visibility sweep.
+     */
+    uint64_t cacheFingerprint() const;
+
+    /**
+     * @brief Groups the edges into equivalence classes. Edges whose satellites are time-shifted copies of another pair
+     * (same two orbits and same phase difference, e.g. the rings of a Walker constellation) have the same windows up to
+     * a time offset. So the windows are only calculated once per equivalence class - either here (lazy_cache = false)
+     * or on demand in findCachedVisibility(). Classes whose visibility is known analytically (see
+     * InterSatelliteLink::getVisibility()) are complete right away and are never swept.
+     *
+     * If a cache_file is set, the windows of all classes are loaded from it, if it was created for the same
+     * fingerprint (see cacheFingerprint()). Otherwise they are calculated at once and the file is (re)written.
+     */
     void createCache();
 
-    std::map<const InterSatelliteLink*, Timeline<>> edge_time_slots;
-    std::map<const InterSatelliteLink*, float>
-        edge_cache_progress; // max. time for which cache (for visibility) is avaiable
+    /**
+     * @brief Visibility windows of an edge: the edge is visible at time t, iff the first edge of its equivalence class
+     * is visible at time t + offset.
+     */
+    struct VisibilityView {
+        uint32_t class_idx; // index in visibility_classes
+        Tick offset;        // in range [0, period)
+    };
+
+    /**
+     * @brief Cached visibility windows of the first edge of an equivalence class. The windows are complete up to the
+     * last sample (progress); a window that is still open at this time begins at window_begin. The windows are found
+     * in the order of time, so they are stored in a sorted array.
+     */
+    struct VisibilityClass {
+        const InterSatelliteLink* representative;
+        std::vector<TimeWindow> windows;
+        Tick progress = -1;                // time of the last sample (-1: not sampled yet, period: complete)
+        Tick window_begin = TICK_INFINITY; // begin of the open window (TICK_INFINITY: not visible at progress)
+    };
+
+    static constexpr double PHASE_RESOLUTION = 1e-5; // [rad] phase differences are compared with this resolution
+
+    // filled lazily by the const queries; they must not run concurrently until the cache is complete (completeCache())
+    mutable std::vector<VisibilityClass> visibility_classes;
+    std::vector<VisibilityView> edge_views;                  // indexed by the ISL index in the instance
+    mutable std::vector<std::vector<uint64_t>> edge_bitmaps; // indexed by the ISL index (VisibilityStore::BITMAP)
+
+    // last known orientation of each satellite and the time when it changed; the version is incremented on every change
+    std::vector<TimelineEvent<glm::vec3>> satellite_orientation;
+    std::vector<uint64_t> orientation_version;
+
+    /**
+     * @brief Result of nextCommunication() for an edge. It is valid for all start times in [t_query, t_result], as long
+     * as the orientation versions of both satellites are the same.
+     */
+    struct CommunicationMemo {
+        float t_query = INFINITY;
+        float t_result = INFINITY;
+        uint64_t version1 = 0;
+        uint64_t version2 = 0;
+    };
+    std::vector<CommunicationMemo> communication_memo; // indexed by the ISL index
 };
 
 } // namespace dmsc
@@ -9,8 +9,8 @@ namespace solver {
 
 class GreedyNext : public Solver {
   public:
-    GreedyNext(const PhysicalInstance& instance)
-        : Solver(instance) {}
+    GreedyNext(const PhysicalInstance& instance, const SolverSettings& settings = SolverSettings())
+        : Solver(instance, settings) {}
 
     DmscSolution solve();
 };
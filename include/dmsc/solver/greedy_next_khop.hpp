@@ -14,8 +14,9 @@ class GreedyNextKHop : public Solver {
      * @brief Construct a new GreedyNextKHop solver object.
      * @param k number of "extra" satellites - e.g. k=1 allows 3 edges (origin, hop, target)
      */
-    GreedyNextKHop(const PhysicalInstance& instance, const unsigned int k)
-        : Solver(instance)
+    GreedyNextKHop(const PhysicalInstance& instance, const unsigned int k,
+                   const SolverSettings& settings = SolverSettings())
+        : Solver(instance, settings)
         , k(k) {}
 
     DmscSolution solve();
@@ -0,0 +1,54 @@
+#ifndef DMSC_TICK_H
+#define DMSC_TICK_H
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace dmsc {
+
+/**
+ * @brief Integer time base that is used for all time sweeps.
+ *
+ * Single precision floats can not be used as a loop variable for long horizons: once t passes 2^24 sec (about 194
+ * days), t += 1 does not change t anymore. Ticks are exact, so sweeps always terminate. Floating point values are only
+ * used at the boundaries (i.e. to calculate positions and in the public solver interface).
+ */
+using Tick = int64_t;
+
+constexpr Tick TICKS_PER_SECOND = 1000000; // [µs]
+constexpr Tick TICK_INFINITY = std::numeric_limits<Tick>::max();
+
+/**
+ * @brief Converts seconds into ticks. Values that can not be represented (e.g. INFINITY) are mapped to TICK_INFINITY.
+ */
+inline Tick toTicks(const double seconds) {
+    if (!(seconds < static_cast<double>(TICK_INFINITY / TICKS_PER_SECOND))) {
+        return TICK_INFINITY;
+    }
+    return std::llround(seconds * TICKS_PER_SECOND);
+}
+
+/**
+ * @brief Converts ticks into seconds. TICK_INFINITY is mapped to INFINITY.
+ */
+inline double toSeconds(const Tick ticks) {
+    if (ticks == TICK_INFINITY) {
+        return INFINITY;
+    }
+    return static_cast<double>(ticks) / TICKS_PER_SECOND;
+}
+
+/**
+ * @brief Adds two tick values without overflowing. If the sum can not be represented, TICK_INFINITY is returned.
+ */
+inline Tick addTicks(const Tick a, const Tick b) {
+    if (a == TICK_INFINITY || b == TICK_INFINITY || a > TICK_INFINITY - b) {
+        return TICK_INFINITY;
+    }
+    return a + b;
+}
+
+} // namespace dmsc
+
+#endif
@@ -2,23 +2,37 @@
 #define DMSC_TIMELINE_H
 
 #include "satellite.hpp"
+#include "tick.hpp"
+#include <algorithm>
 #include <map>
 #include <set>
+#include <vector>
 
 namespace dmsc {
 
 constexpr float TIMELINE_ERR = std::numeric_limits<float>::infinity();
 
+/**
+ * @brief Error value for a timeline with the given time type (infinity for floating point types; the maximum value
+ * for integer types like Tick).
+ */
+template <typename Time>
+constexpr Time timelineError() {
+    return std::numeric_limits<Time>::has_infinity ? std::numeric_limits<Time>::infinity()
+                                                   : std::numeric_limits<Time>::max();
+}
+
 // ------------------------------------------------------------------------------------------------
 
 /**
  * @brief Continuous interval on a timeline with payload data.
+ * The time is given in [sec] by default. Use Tick as time type for an exact integer time base.
  */
-template <typename PayloadData = unsigned char>
+template <typename PayloadData = unsigned char, typename Time = float>
 struct TimelineEvent {
-    float t_begin = TIMELINE_ERR;     // time when the event starts
-    float t_end = TIMELINE_ERR;       // time when the event ends
-    PayloadData data = PayloadData(); // data that is associated with the event
+    Time t_begin = timelineError<Time>(); // time when the event starts
+    Time t_end = timelineError<Time>();   // time when the event ends
+    PayloadData data = PayloadData();     // data that is associated with the event
 
     /**
      * @brief Constructs a new TimelineEvent object. By default this object is invalid (see isValid function).
@@ -28,7 +42,7 @@ struct TimelineEvent {
     /**
      * @brief Constructs a new TimelineEvent object.
      */
-    TimelineEvent(const float t_begin, const float t_end, const PayloadData& data = PayloadData())
+    TimelineEvent(const Time t_begin, const Time t_end, const PayloadData& data = PayloadData())
         : t_begin(t_begin)
         , t_end(t_end)
         , data(data) {}
@@ -46,18 +60,70 @@ struct TimelineEvent {
      * value was used.
      */
     bool isValid() const {
-        return t_end >= t_begin && t_begin >= 0.f && t_begin != TIMELINE_ERR && t_end != TIMELINE_ERR;
+        return t_end >= t_begin && t_begin >= Time(0) && t_begin != timelineError<Time>() &&
+               t_end != timelineError<Time>();
     }
 };
 
 // ------------------------------------------------------------------------------------------------
 
+/**
+ * @brief Closed interval [t_begin, t_end] without payload. Long lists of windows that are only appended in the order of
+ * time are stored in sorted arrays instead of a Timeline: they don't allocate a node per window and are searched with a
+ * binary search (see nextTimeInWindows()).
+ */
+struct TimeWindow {
+    Tick t_begin;
+    Tick t_end;
+};
+
+/**
+ * @brief Appends a window to a sorted array of windows. Like Timeline::insert(), invalid windows and windows that
+ * overlap with the last one are rejected.
+ * @return true, if the window was appended
+ */
+inline bool appendWindow(std::vector<TimeWindow>& windows, const Tick t_begin, const Tick t_end) {
+    if (t_end < t_begin || t_begin < 0) {
+        return false;
+    }
+    if (!windows.empty() && (windows.back().t_begin >= t_begin || windows.back().t_end > t_begin)) {
+        return false;
+    }
+    windows.push_back({t_begin, t_end});
+    return true;
+}
+
+/**
+ * @brief Same as Timeline::prevailingEvent() for a sorted array of windows: returns the window that is active at time
+ * t or the next one. Like in a Timeline, a window is not active at its end (unless it is empty).
+ * @return windows.end() if there is no such window
+ */
+inline std::vector<TimeWindow>::const_iterator findWindow(const std::vector<TimeWindow>& windows, const Tick t) {
+    return std::lower_bound(windows.begin(), windows.end(), t, [](const TimeWindow& w, const Tick t) {
+        return w.t_begin < t && w.t_end <= t;
+    });
+}
+
+/**
+ * @brief Same as Timeline::nextTimeWithEvent() for a sorted array of windows: returns t, if a window is active at time
+ * t, or the begin of the next window (see findWindow()).
+ * @return TICK_INFINITY if there is no such window
+ */
+inline Tick nextTimeInWindows(const std::vector<TimeWindow>& windows, const Tick t) {
+    auto window = findWindow(windows, t);
+    return window == windows.end() ? TICK_INFINITY : std::max(t, window->t_begin);
+}
+
+// ------------------------------------------------------------------------------------------------
+
 /**
  * @brief Timeline containing TimelineEvents that do not overlap.
  */
-template <typename PayloadData = unsigned char>
+template <typename PayloadData = unsigned char, typename Time = float>
 class Timeline {
   public:
+    using Event = TimelineEvent<PayloadData, Time>;
+
     /**
      * @brief Construct a new Timeline object
      */
@@ -79,14 +145,14 @@ class Timeline {
      *
      * @return true, if the event was inserted into this timeline
      */
-    bool insert(const TimelineEvent<PayloadData>& event) {
+    bool insert(const Event& event) {
         if (!event.isValid()) {
             return false;
         }
 
-        float t_next = nextTimeWithEvent(event.t_begin, false);
+        Time t_next = nextTimeWithEvent(event.t_begin, false);
         // is there an event that overlaps with the new one?
-        if (t_next != -1.f && t_next < event.t_end) {
+        if (t_next != Time(-1) && t_next < event.t_end) {
             return false;
         }
 
@@ -96,7 +162,7 @@ class Timeline {
     /**
      * @brief Removes an event from this timeline.
      */
-    void remove(const TimelineEvent<PayloadData>& event) {
+    void remove(const Event& event) {
         auto it = events.find(event);
         if (it != events.end()) {
             events.erase(it);
@@ -111,12 +177,12 @@ class Timeline {
      *
      * If no valid time is found, -1 is returned.
      */
-    float nextTimeWithEvent(const float t, const bool allow_loop = false) const {
+    Time nextTimeWithEvent(const Time t, const bool allow_loop = false) const {
         if (events.size() == 0) {
-            return -1.f;
+            return Time(-1);
         }
 
-        TimelineEvent<PayloadData> tmp(t, t);
+        Event tmp(t, t);
         auto e = events.lower_bound(tmp); // the first event that is NOT less than tmp (see "<" of TimelineEvent)
         if (e != events.end()) {
             if (e->t_begin <= t) { // event is currently active
@@ -128,7 +194,7 @@ class Timeline {
             return events.begin()->t_begin;
         }
 
-        return -1.f;
+        return Time(-1);
     }
 
     /**
@@ -140,12 +206,12 @@ class Timeline {
      *
      * If no such event is found, an invalid event is returned.
      */
-    TimelineEvent<PayloadData> prevailingEvent(const float t, const bool allow_loop = false) const {
+    Event prevailingEvent(const Time t, const bool allow_loop = false) const {
         if (events.size() == 0) {
-            return TimelineEvent<PayloadData>(TIMELINE_ERR, -1.f);
+            return Event(timelineError<Time>(), Time(-1));
         }
 
-        TimelineEvent<PayloadData> tmp(t, t);
+        Event tmp(t, t);
         auto e = events.lower_bound(tmp); // the first element that is NOT less than tmp (see "<" of TimelineEvent)
         if (e != events.end()) {
             return *e;
@@ -153,7 +219,7 @@ class Timeline {
             return *events.begin();
         }
 
-        return TimelineEvent<PayloadData>(TIMELINE_ERR, -1.f);
+        return Event(timelineError<Time>(), Time(-1));
     }
 
     /**
@@ -164,12 +230,12 @@ class Timeline {
      *
      * If no such event is found, an invalid event is returned.
      */
-    TimelineEvent<PayloadData> previousEvent(const float t, const bool allow_loop = false) const {
+    Event previousEvent(const Time t, const bool allow_loop = false) const {
         if (events.size() == 0) {
-            return TimelineEvent<PayloadData>(TIMELINE_ERR, -1.f);
+            return Event(timelineError<Time>(), Time(-1));
         }
 
-        TimelineEvent<PayloadData> tmp(t, t);
+        Event tmp(t, t);
         auto e = events.lower_bound(tmp); // the first element that is NOT less than tmp (see "<" of TimelineEvent)
         if (e != events.begin()) {
             return *--e; // there is at least one element (see above) -> even if e is end(), we will get a valid event
@@ -177,22 +243,22 @@ class Timeline {
             return *--events.end();
         }
 
-        return TimelineEvent<PayloadData>(TIMELINE_ERR, -1.f);
+        return Event(timelineError<Time>(), Time(-1));
     }
 
     /**
      * @brief Returns the last event. If no events was insterted before, an invalid event is returned.
      */
-    TimelineEvent<PayloadData> lastEvent() const {
+    Event lastEvent() const {
         if (events.size() == 0) {
-            return TimelineEvent<PayloadData>(TIMELINE_ERR, -1.f);
+            return Event(timelineError<Time>(), Time(-1));
         }
 
         return *--events.end();
     }
 
   private:
-    std::set<TimelineEvent<PayloadData>> events;
+    std::set<Event> events;
 };
 
 } // namespace dmsc
@@ -62,4 +62,16 @@ std::pair<bool, AnimationDetails> Animation::getISLAnimation(const size_t isl_id
     return {false, AnimationDetails()};
 }
 
+// ------------------------------------------------------------------------------------------------
+
+void Animation::remapISLs(const std::vector<uint32_t>& isl_map) {
+    std::map<size_t, Timeline<AnimationDetails>> remapped;
+    for (auto& isl : intersatellite_links) {
+        if (isl.first < isl_map.size() && isl_map[isl.first] != ~0u) {
+            remapped[isl_map[isl.first]] = std::move(isl.second);
+        }
+    }
+    intersatellite_links = std::move(remapped);
+}
+
 } // namespace dmsc
@@ -1,9 +1,12 @@
 #include "dmsc/edge.hpp"
+#include "vector_math.hpp"
+#include <algorithm>
 
 namespace dmsc {
 
 InterSatelliteLink::InterSatelliteLink(const uint32_t& v1_idx, const uint32_t& v2_idx,
-                                       const std::vector<Satellite>& satellites, const CentralMass cm)
+                                       const std::vector<Satellite>& satellites, const CentralMass cm,
+                                       const float horizon, const bool hyperperiod)
     : v1_idx(v1_idx)
     , v2_idx(v2_idx)
     , cm(cm) {
@@ -16,61 +19,117 @@ InterSatelliteLink::InterSatelliteLink(const uint32_t& v1_idx, const uint32_t& v
 
     v1 = &satellites[v1_idx];
     v2 = &satellites[v2_idx];
-    period = v1->getPeriod();
-    if (v1->getSemiMajorAxis() != v2->getSemiMajorAxis()) {
-        period = v1->getPeriod() * v2->getPeriod(); // [sec]
+
+    // both satellites have to be back at their initial positions; this only holds exactly for the same altitude
+    if (v1->getSemiMajorAxis() == v2->getSemiMajorAxis()) {
+        periodic = true;
+        period = v1->getPeriod(); // [sec]
+        this->horizon = INFINITY;
+    } else {
+        double common_period =
+            hyperperiod ? math::findHyperperiod(v1->getPeriod(), v2->getPeriod(), HYPERPERIOD_TOLERANCE, horizon)
+                        : INFINITY;
+        periodic = common_period <= horizon;
+        period = periodic ? static_cast<float>(common_period) : horizon; // [sec]
+        this->horizon = horizon;
     }
+    visibility = classifyVisibility();
 };
 
 // ------------------------------------------------------------------------------------------------
 
+EdgeVisibility InterSatelliteLink::classifyVisibility() const {
+    if (&v1->getOrbit() != &v2->getOrbit() || v1->getOrbitClass() != OrbitClass::CIRCULAR) {
+        return EdgeVisibility::VARIES;
+    }
+
+    // the line of sight is a chord of the orbit; its distance to the center is r * cos(angle / 2)
+    double angle = math::wrapAngle(double(v2->getInitialMeanAnomaly()) - v1->getInitialMeanAnomaly());
+    double clearance = v1->getSemiMajorAxis() * std::abs(std::cos(angle / 2)) - cm.radius_central_mass; // [km]
+    if (clearance >= CLASSIFICATION_MARGIN) {
+        return EdgeVisibility::ALWAYS;
+    } else if (clearance <= -CLASSIFICATION_MARGIN) {
+        return EdgeVisibility::NEVER;
+    }
+    return EdgeVisibility::VARIES;
+}
+
+// ------------------------------------------------------------------------------------------------
+
 bool InterSatelliteLink::isBlocked(const float time) const {
-    // represent edge as a unit vector with origin at one of the satellites
-    glm::vec3 sat1 = v1->cartesian_coordinates(time);
-    glm::vec3 sat2 = v2->cartesian_coordinates(time);
-    glm::vec3 direction = glm::normalize(sat2 - sat1);
-
-    // check for intersection with a sphere (earth)
-    glm::vec3 sphere_center = glm::vec3(0.f);
-    glm::vec3 origin = sat1 - sphere_center;
-
-    float a = glm::dot(direction, direction);
-    float b = 2.f * glm::dot(origin, direction);
-    float c = glm::dot(origin, origin) - cm.radius_central_mass * cm.radius_central_mass;
-    float discr = b * b - 4 * a * c;
-
-    if (discr < .0f) { // no intersection at all
-        return false;
-    } else { // intersection possible (in front of or behind the ray-origin)
-        float t = -b - sqrt(discr);
-        if (t > .0f)
-            return true;
-
-        t = -b + sqrt(discr);
-        return t > .0f;
+    return isBlocked(v1->cartesian_coordinates(time), v2->cartesian_coordinates(time));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool InterSatelliteLink::isBlocked(const glm::vec3& sat1, const glm::vec3& sat2) const {
+    return clearance(sat1, sat2) < 0.f;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float InterSatelliteLink::clearance(const float time) const {
+    return clearance(v1->cartesian_coordinates(time), v2->cartesian_coordinates(time));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float InterSatelliteLink::clearance(const glm::vec3& sat1, const glm::vec3& sat2) const {
+    // point on the line of sight (sat1 + s * direction, s in [0, 1]) that is closest to the center of the central mass
+    glm::vec3 direction = sat2 - sat1;
+    float length_squared = glm::dot(direction, direction);
+    float s = 0.f;
+    if (length_squared > 0.f) {
+        s = glm::clamp(-glm::dot(sat1, direction) / length_squared, 0.f, 1.f);
     }
+    return glm::length(sat1 + s * direction) - cm.radius_central_mass;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+double InterSatelliteLink::clearance(const double time) const {
+    return clearance(v1->cartesian_coordinates(time), v2->cartesian_coordinates(time));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+double InterSatelliteLink::clearance(const glm::dvec3& sat1, const glm::dvec3& sat2) const {
+    glm::dvec3 direction = sat2 - sat1;
+    double length_squared = glm::dot(direction, direction);
+    double s = 0.0;
+    if (length_squared > 0.0) {
+        s = glm::clamp(-glm::dot(sat1, direction) / length_squared, 0.0, 1.0);
+    }
+    return glm::length(sat1 + s * direction) - cm.radius_central_mass;
 }
 
 // ------------------------------------------------------------------------------------------------
 
 bool InterSatelliteLink::canAlign(const TimelineEvent<glm::vec3>& sat1, const TimelineEvent<glm::vec3>& sat2,
                                   const float t) const {
+    return alignmentSlack(sat1, sat2, t) >= 0.f;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float InterSatelliteLink::alignmentSlack(const TimelineEvent<glm::vec3>& sat1, const TimelineEvent<glm::vec3>& sat2,
+                                         const float t) const {
     glm::vec3 target = getOrientation(t);
     float angle_sat1 = .0f;
     float angle_sat2 = .0f;
     float time_sat1 = .0f;
     float time_sat2 = .0f;
 
-    // calc angle between orientations; direction vectors must be length 1
+    // calc angle between orientations; direction vectors must be length 1 (rounding errors must not lead to NaN)
     if (sat1.isValid()) {
-        angle_sat1 = std::acos(glm::dot(sat1.data, target)); // [rad]
+        angle_sat1 = std::acos(glm::clamp(glm::dot(sat1.data, target), -1.f, 1.f)); // [rad]
         time_sat1 = sat1.t_begin;
     } else {
         time_sat1 = 0.f; // event is invalid, so assume that sat1 was not part of a communication yet
     }
 
     if (sat2.isValid()) {
-        angle_sat2 = std::acos(glm::dot(sat2.data, -target)); // [rad]
+        angle_sat2 = std::acos(glm::clamp(glm::dot(sat2.data, -target), -1.f, 1.f)); // [rad]
         time_sat2 = sat2.t_begin;
     } else {
         time_sat2 = 0.f; // event is invalid, so assume that sat1 was not part of a communication yet
@@ -80,12 +139,31 @@ bool InterSatelliteLink::canAlign(const TimelineEvent<glm::vec3>& sat1, const Ti
     float turn_time_s1 = angle_sat1 / v1->getRotationSpeed(); // [sec]
     float turn_time_s2 = angle_sat2 / v2->getRotationSpeed(); // [sec]
 
-    // enough time?
-    if (turn_time_s1 > t - time_sat1 || turn_time_s2 > t - time_sat2) {
-        return false;
-    }
+    // time that is left after turning (x - y >= 0 iff x >= y, so the sign matches the comparison of both times)
+    return std::min((t - time_sat1) - turn_time_s1, (t - time_sat2) - turn_time_s2);
+}
 
-    return true;
+// ------------------------------------------------------------------------------------------------
+
+double InterSatelliteLink::alignmentSlack(const TimelineEvent<glm::vec3>& sat1, const TimelineEvent<glm::vec3>& sat2,
+                                          const double t) const {
+    glm::dvec3 target = getOrientation(t);
+
+    // angle between two directions; atan2 stays accurate for small angles (unlike acos of the dot product)
+    auto angle = [](const glm::dvec3& a, const glm::dvec3& b) {
+        return std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b)); // [rad]
+    };
+
+    // an invalid event means that the satellite was not part of a communication yet
+    double slack_sat1 = t;
+    double slack_sat2 = t;
+    if (sat1.isValid()) {
+        slack_sat1 = (t - sat1.t_begin) - angle(glm::dvec3(sat1.data), target) / v1->getRotationSpeed();
+    }
+    if (sat2.isValid()) {
+        slack_sat2 = (t - sat2.t_begin) - angle(glm::dvec3(sat2.data), -target) / v2->getRotationSpeed();
+    }
+    return std::min(slack_sat1, slack_sat2);
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -96,4 +174,12 @@ glm::vec3 InterSatelliteLink::getOrientation(const float time) const {
     return glm::normalize(sat2 - sat1);
 }
 
+// ------------------------------------------------------------------------------------------------
+
+glm::dvec3 InterSatelliteLink::getOrientation(const double time) const {
+    glm::dvec3 sat1 = v1->cartesian_coordinates(time);
+    glm::dvec3 sat2 = v2->cartesian_coordinates(time);
+    return glm::normalize(sat2 - sat1);
+}
+
 } // namespace dmsc
@@ -0,0 +1,108 @@
+#include "dmsc/ephemeris.hpp"
+#include "vector_math.hpp"
+
+namespace dmsc {
+
+namespace {
+
+/**
+ * @brief Exact position of the satellite (ignores the propagation mode of the satellite).
+ */
+glm::vec3 exactPosition(const Satellite& satellite, const double time) {
+    return satellite.cartesian_coordinates_angle(satellite.trueAnomaly(static_cast<float>(time)));
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+
+ChebyshevEphemeris::ChebyshevEphemeris(const Satellite& satellite, const float tolerance, const uint32_t degree)
+    : period(satellite.getPeriod())
+    , degree(degree) {
+
+    for (segments = 8; segments <= MAX_SEGMENTS; segments *= 2) {
+        fit(satellite);
+        max_error = measureError(satellite);
+        if (max_error <= tolerance) {
+            break;
+        }
+    }
+
+    if (segments > MAX_SEGMENTS) { // use the finest approximation even if the tolerance is not reached
+        segments = MAX_SEGMENTS;
+        fit(satellite);
+        max_error = measureError(satellite);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void ChebyshevEphemeris::fit(const Satellite& satellite) {
+    const uint32_t n = degree + 1; // number of nodes and coefficients
+    segment_length = period / segments;
+    coefficients.assign(static_cast<size_t>(segments) * 3 * n, 0.f);
+
+    std::vector<glm::vec3> samples(n);
+    for (uint32_t s = 0; s < segments; s++) {
+        // sample the exact position at the chebyshev nodes of this segment
+        double t_mid = (s + .5) * segment_length;
+        for (uint32_t j = 0; j < n; j++) {
+            double x = std::cos(M_PI * (j + .5) / n);
+            samples[j] = exactPosition(satellite, t_mid + x * segment_length / 2.0);
+        }
+
+        // discrete chebyshev transform
+        float* c = &coefficients[static_cast<size_t>(s) * 3 * n];
+        for (uint32_t k = 0; k < n; k++) {
+            double sum[3] = {0.0, 0.0, 0.0};
+            for (uint32_t j = 0; j < n; j++) {
+                double w = std::cos(M_PI * k * (j + .5) / n);
+                sum[0] += w * samples[j].x;
+                sum[1] += w * samples[j].y;
+                sum[2] += w * samples[j].z;
+            }
+            double scale = (k == 0 ? 1.0 : 2.0) / n;
+            for (uint32_t axis = 0; axis < 3; axis++) {
+                c[axis * n + k] = static_cast<float>(scale * sum[axis]);
+            }
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float ChebyshevEphemeris::measureError(const Satellite& satellite) const {
+    // the error is largest between the interpolation nodes -> check a grid that does not contain any node
+    const uint32_t checks_per_segment = 2 * (degree + 1) + 1;
+    float error = 0.f;
+    for (uint32_t s = 0; s < segments; s++) {
+        for (uint32_t i = 0; i < checks_per_segment; i++) {
+            double t = (s + (i + .5) / checks_per_segment) * segment_length;
+            error = std::max(error, glm::length(evaluate(t) - exactPosition(satellite, t)));
+        }
+    }
+    return error;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+glm::vec3 ChebyshevEphemeris::evaluate(const double time) const {
+    const uint32_t n = degree + 1;
+
+    // find segment and map time to [-1, 1]
+    double t = time - period * std::floor(time / period);
+    uint32_t s = std::min(static_cast<uint32_t>(t / segment_length), segments - 1);
+    float x = static_cast<float>(2.0 * (t - s * segment_length) / segment_length - 1.0);
+
+    // clenshaw recurrence for all three axes
+    const float* c = &coefficients[static_cast<size_t>(s) * 3 * n];
+    glm::vec3 b1 = glm::vec3(0.f), b2 = glm::vec3(0.f);
+    for (uint32_t k = degree; k >= 1; k--) {
+        glm::vec3 b0 = 2.f * x * b1 - b2 + glm::vec3(c[k], c[n + k], c[2 * n + k]);
+        b2 = b1;
+        b1 = b0;
+    }
+    return x * b1 - b2 + glm::vec3(c[0], c[n], c[2 * n]);
+}
+
+} // namespace dmsc
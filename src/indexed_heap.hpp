@@ -0,0 +1,112 @@
+#ifndef DMSC_INDEXED_HEAP
+#define DMSC_INDEXED_HEAP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace dmsc {
+
+/**
+ * @brief Binary min-heap of the ids 0 .. capacity - 1 with a key per id. The position of every id in the heap is
+ * stored, so the key of an id can be changed (or the id removed) in O(log n).
+ */
+template <typename Key, typename Compare = std::less<Key>>
+class IndexedMinHeap {
+  public:
+    explicit IndexedMinHeap(const size_t capacity)
+        : position(capacity, NOT_CONTAINED) {}
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    bool contains(const uint32_t id) const { return position[id] != NOT_CONTAINED; }
+
+    /**
+     * @brief Id with the smallest key (heap must not be empty).
+     */
+    uint32_t top() const { return heap.front().first; }
+    const Key& topKey() const { return heap.front().second; }
+
+    /**
+     * @brief Inserts the id or changes its key, if it is already contained.
+     */
+    void push(const uint32_t id, const Key& key) {
+        if (contains(id)) {
+            size_t pos = position[id];
+            bool decreased = compare(key, heap[pos].second);
+            heap[pos].second = key;
+            decreased ? siftUp(pos) : siftDown(pos);
+            return;
+        }
+        position[id] = heap.size();
+        heap.emplace_back(id, key);
+        siftUp(heap.size() - 1);
+    }
+
+    /**
+     * @brief Removes the id with the smallest key (heap must not be empty).
+     */
+    void pop() { erase(top()); }
+
+    void erase(const uint32_t id) {
+        size_t pos = position[id];
+        position[id] = NOT_CONTAINED;
+        if (pos + 1 == heap.size()) {
+            heap.pop_back();
+            return;
+        }
+
+        // fill the gap with the last entry, which can be smaller or larger than the removed one
+        heap[pos] = std::move(heap.back());
+        heap.pop_back();
+        position[heap[pos].first] = pos;
+        siftUp(pos);
+        siftDown(pos);
+    }
+
+  private:
+    static constexpr size_t NOT_CONTAINED = ~size_t(0);
+
+    void siftUp(size_t pos) {
+        while (pos > 0) {
+            size_t parent = (pos - 1) / 2;
+            if (!compare(heap[pos].second, heap[parent].second)) {
+                break;
+            }
+            swap(pos, parent);
+            pos = parent;
+        }
+    }
+
+    void siftDown(size_t pos) {
+        while (true) {
+            size_t smallest = pos;
+            for (size_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < heap.size(); child++) {
+                if (compare(heap[child].second, heap[smallest].second)) {
+                    smallest = child;
+                }
+            }
+            if (smallest == pos) {
+                break;
+            }
+            swap(pos, smallest);
+            pos = smallest;
+        }
+    }
+
+    void swap(const size_t a, const size_t b) {
+        std::swap(heap[a], heap[b]);
+        position[heap[a].first] = a;
+        position[heap[b].first] = b;
+    }
+
+    std::vector<std::pair<uint32_t, Key>> heap; // (id, key)
+    std::vector<size_t> position;               // position of every id in heap
+    Compare compare;
+};
+
+} // namespace dmsc
+
+#endif
@@ -1,4 +1,6 @@
 #include "dmsc/instance.hpp"
+#include "dmsc/line_of_sight.hpp"
+#include "thread_pool.hpp"
 #include <algorithm>
 #include <ctime>
 #include <fstream>
@@ -154,16 +156,74 @@ void Instance::save(const std::string& file) const {
 // = Physical Instance
 // ========================
 
+namespace {
+
+/**
+ * @brief Checks the given ISLs every second of their period and returns a bitmask of the ISLs that are visible at least
+ * once (bit i for ISL group[i]). At most 64 ISLs can be checked at once.
+ */
+uint64_t findVisibleISLs(const std::vector<Satellite>& satellites, const std::vector<InterSatelliteLink>& isls,
+                         const std::vector<uint32_t>& group, const float radius) {
+    const size_t samples = 64; // time samples per propagation
+    const size_t n = group.size();
+
+    // only the satellites of these ISLs are propagated
+    std::vector<uint32_t> subset;
+    std::map<uint32_t, uint32_t> local_idx; // index in satellites -> index in subset
+    auto localIndex = [&](const uint32_t idx) {
+        auto inserted = local_idx.insert({idx, static_cast<uint32_t>(subset.size())});
+        if (inserted.second) {
+            subset.push_back(idx);
+        }
+        return inserted.first->second;
+    };
+    std::vector<uint32_t> from(n), to(n);
+    std::vector<std::pair<Tick, uint32_t>> periods(n); // sorted by period
+    for (uint32_t i = 0; i < n; i++) {
+        from[i] = localIndex(isls[group[i]].getV1Idx());
+        to[i] = localIndex(isls[group[i]].getV2Idx());
+        periods[i] = {isls[group[i]].getPeriodTicks(), i};
+    }
+    std::sort(periods.begin(), periods.end());
+
+    ConstellationPropagator propagator(satellites, subset);
+    PositionBuffer positions;
+    VisibilityMask visible;
+    uint64_t ever_visible = 0;
+    uint64_t undecided = n == 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1; // neither visible nor expired yet
+    size_t next_expiry = 0;                                                // position in periods
+
+    for (Tick t0 = 0; undecided != 0; t0 += samples * TICKS_PER_SECOND) {
+        propagator.propagate(toSeconds(t0), 1.0, samples, positions);
+        for (size_t s = 0; s < samples && undecided != 0; s++) {
+            Tick t = t0 + s * TICKS_PER_SECOND;
+            for (; next_expiry < n && periods[next_expiry].first <= t; next_expiry++) {
+                undecided &= ~(uint64_t(1) << periods[next_expiry].second);
+            }
+
+            checkLineOfSight(positions, s * subset.size(), from, to, radius, visible);
+            ever_visible |= visible[0] & undecided;
+            undecided &= ~visible[0];
+        }
+    }
+    return ever_visible;
+}
+
+} // namespace
+
 PhysicalInstance::PhysicalInstance(const PhysicalInstance& source) {
     cm.radius_central_mass = source.cm.radius_central_mass;
     cm.gravitational_parameter = source.cm.gravitational_parameter;
+    planning_horizon = source.planning_horizon;
+    hyperperiod = source.hyperperiod;
     satellites = source.satellites;
     adjacency_list = source.adjacency_list;
     scheduled_communications = source.scheduled_communications;
 
     // edges must point to the new orbit objects
     for (const InterSatelliteLink& isl : source.intersatellite_links) {
-        intersatellite_links.push_back(InterSatelliteLink(isl.getV1Idx(), isl.getV2Idx(), satellites, cm));
+        intersatellite_links.push_back(
+            InterSatelliteLink(isl.getV1Idx(), isl.getV2Idx(), satellites, cm, planning_horizon, hyperperiod));
     }
 }
 
@@ -172,10 +232,20 @@ PhysicalInstance::PhysicalInstance(const PhysicalInstance& source) {
 PhysicalInstance::PhysicalInstance(const Instance& raw_instance) {
     cm = raw_instance.cm;
 
-    // Satellites
+    // Satellites (all satellites of an orbital plane share one orbit)
     satellites.reserve(raw_instance.satellites.size());
+    std::vector<size_t> planes; // index of the first satellite of every orbital plane
     for (const auto& sv : raw_instance.satellites) {
-        satellites.push_back(Satellite(sv, cm));
+        auto plane = std::find_if(planes.begin(), planes.end(), [&](const size_t idx) {
+            return raw_instance.satellites[idx].isSameOrbit(sv);
+        });
+
+        if (plane == planes.end()) {
+            planes.push_back(satellites.size());
+            satellites.push_back(Satellite(sv, cm));
+        } else {
+            satellites.push_back(Satellite(sv, cm, satellites[*plane].getSharedOrbit()));
+        }
     }
 
     // Edges
@@ -188,7 +258,8 @@ PhysicalInstance::PhysicalInstance(const Instance& raw_instance) {
 
         switch (e.type) {
         case EdgeType::INTERSATELLITE_LINK:
-            intersatellite_links.push_back(InterSatelliteLink(e.from_idx, e.to_idx, satellites, cm));
+            intersatellite_links.push_back(
+                InterSatelliteLink(e.from_idx, e.to_idx, satellites, cm, planning_horizon, hyperperiod));
             break;
         case EdgeType::SCHEDULED_COMMUNICATION:
             scheduled_communications.push_back({e.from_idx, e.to_idx});
@@ -223,6 +294,8 @@ PhysicalInstance& PhysicalInstance::operator=(const PhysicalInstance& source) {
 
     cm.radius_central_mass = source.cm.radius_central_mass;
     cm.gravitational_parameter = source.cm.gravitational_parameter;
+    planning_horizon = source.planning_horizon;
+    hyperperiod = source.hyperperiod;
     satellites = source.satellites;
     satellites.shrink_to_fit();
     adjacency_list = source.adjacency_list;
@@ -231,7 +304,8 @@ PhysicalInstance& PhysicalInstance::operator=(const PhysicalInstance& source) {
     // edges must point to the new orbit objects
     intersatellite_links.clear();
     for (const InterSatelliteLink& isl : source.intersatellite_links) {
-        intersatellite_links.push_back(InterSatelliteLink(isl.getV1Idx(), isl.getV2Idx(), satellites, cm));
+        intersatellite_links.push_back(
+            InterSatelliteLink(isl.getV1Idx(), isl.getV2Idx(), satellites, cm, planning_horizon, hyperperiod));
     }
 
     intersatellite_links.shrink_to_fit();
@@ -240,24 +314,67 @@ PhysicalInstance& PhysicalInstance::operator=(const PhysicalInstance& source) {
 
 // ------------------------------------------------------------------------------------------------
 
-void PhysicalInstance::removeInvalidISL() {
-    for (int i = (int)intersatellite_links.size() - 1; i >= 0; i--) {
-        const InterSatelliteLink& e = intersatellite_links[i];
-        bool get_visible = false;
-        for (float t = 0.0f; t < e.getPeriod(); t += 1.0f) {
-            if (!e.isBlocked(t)) {
-                get_visible = true;
-                break;
+void PhysicalInstance::setPropagationMode(const PropagationMode mode) {
+    for (Satellite& satellite : satellites) {
+        satellite.setPropagationMode(mode);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void PhysicalInstance::setPlanningHorizon(const float horizon, const bool hyperperiod) {
+    planning_horizon = horizon;
+    this->hyperperiod = hyperperiod;
+    for (InterSatelliteLink& isl : intersatellite_links) {
+        isl = InterSatelliteLink(isl.getV1Idx(), isl.getV2Idx(), satellites, cm, planning_horizon, hyperperiod);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+std::vector<uint32_t> PhysicalInstance::removeInvalidISL() {
+    // an ISL is kept, if it is visible at least once within its period; ISLs whose visibility is known analytically
+    // are decided right away, all others are checked in groups of 64 (one word of the line of sight kernel) on a
+    // thread pool
+    const size_t n = intersatellite_links.size();
+    std::vector<bool> keep(n);
+    std::vector<std::vector<uint32_t>> groups;
+    for (uint32_t i = 0; i < n; i++) {
+        keep[i] = intersatellite_links[i].getVisibility() == EdgeVisibility::ALWAYS;
+        if (intersatellite_links[i].getVisibility() == EdgeVisibility::VARIES) {
+            if (groups.empty() || groups.back().size() == 64) {
+                groups.emplace_back();
             }
+            groups.back().push_back(i);
+        }
+    }
+
+    VisibilityMask ever_visible(groups.size(), 0);
+    ThreadPool pool;
+    pool.parallelFor(groups.size(), [&](const size_t i) {
+        ever_visible[i] = findVisibleISLs(satellites, intersatellite_links, groups[i], cm.radius_central_mass);
+    });
+    for (size_t i = 0; i < groups.size(); i++) {
+        for (size_t j = 0; j < groups[i].size(); j++) {
+            keep[groups[i][j]] = ever_visible[i] >> j & 1;
         }
+    }
 
-        // remove edge
-        if (!get_visible) {
-            intersatellite_links.erase(intersatellite_links.begin() + i);
+    // move the remaining edges to the front (in one pass, so the order doesn't change)
+    std::vector<uint32_t> isl_map(n, ~0u);
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (keep[i]) {
+            if (kept != i) {
+                intersatellite_links[kept] = intersatellite_links[i];
+            }
+            isl_map[i] = kept++;
         }
     }
+    intersatellite_links.erase(intersatellite_links.begin() + kept, intersatellite_links.end());
     intersatellite_links.shrink_to_fit();
     buildAdjacencyMatrix();
+    return isl_map;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -0,0 +1,172 @@
+#include "dmsc/kepler.hpp"
+#include "vector_math.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+namespace dmsc {
+
+namespace {
+
+/**
+ * @brief Reference solution of Kepler's equation in double precision. M - E + e * sin(E) is monotonic in E, so
+ * bisection always converges (independent of the eccentricity).
+ */
+double referenceSolve(const double eccentricity, const double mean_anomaly) {
+    double lower = 0.0, upper = math::TWO_PI;
+    for (int i = 0; i < 64; i++) {
+        double mid = .5 * (lower + upper);
+        if (mid - eccentricity * std::sin(mid) < mean_anomaly) {
+            lower = mid;
+        } else {
+            upper = mid;
+        }
+    }
+    return .5 * (lower + upper);
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+
+KeplerSolver::KeplerSolver(const float eccentricity, const float tolerance)
+    : eccentricity(eccentricity) {
+    if (eccentricity < 0.f || eccentricity >= 1.f) {
+        printf("Kepler's equation can not be solved for an eccentricity of %f. "
+               "Eccentricity has to be in range [0,1).\n",
+               eccentricity);
+        assert(false);
+        exit(EXIT_FAILURE);
+    }
+    half_angle_factor = std::sqrt((1.f + eccentricity) / (1.f - eccentricity));
+
+    table.resize(TABLE_SIZE + 1);
+    for (uint32_t i = 0; i <= TABLE_SIZE; i++) {
+        table[i] = static_cast<float>(referenceSolve(eccentricity, i * math::TWO_PI / TABLE_SIZE));
+    }
+
+    // the reference solutions of the verification grid are the same for every number of steps
+    const uint32_t checks = TABLE_SIZE * CHECKS_PER_ENTRY;
+    std::vector<double> reference(checks);
+    for (uint32_t j = 0; j < checks; j++) {
+        reference[j] = referenceSolve(eccentricity, checkAnomaly(j));
+    }
+
+    // use as few steps as possible; one additional step covers the error between the points of the grid
+    for (iterations = 0; iterations < MAX_ITERATIONS; iterations++) {
+        if (measureError(reference) <= tolerance) {
+            break;
+        }
+    }
+    iterations = std::min(iterations + 1, MAX_ITERATIONS);
+    max_error = measureError(reference);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float KeplerSolver::startingValue(const float mean_anomaly) const {
+    // linear interpolation between the two closest table entries
+    float pos = mean_anomaly * static_cast<float>(TABLE_SIZE / math::TWO_PI);
+    uint32_t idx = std::min(static_cast<uint32_t>(pos), TABLE_SIZE - 1);
+    float frac = pos - static_cast<float>(idx);
+    return table[idx] + frac * (table[idx + 1] - table[idx]);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float KeplerSolver::solve(const float mean_anomaly) const {
+    float e = startingValue(mean_anomaly);
+    for (uint32_t k = 0; k < iterations; k++) {
+        float sin_e, cos_e;
+        math::sincos(e, sin_e, cos_e);
+        float f = e - eccentricity * sin_e - mean_anomaly; // f(E)
+        float df = 1.f - eccentricity * cos_e;             // f'(E)
+        float ddf = eccentricity * sin_e;                  // f''(E)
+        e -= f * df / (df * df - .5f * f * ddf);           // halley step
+    }
+    return e;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void KeplerSolver::solve(const float* mean_anomaly, float* eccentric_anomaly, const size_t n) const {
+    // all values perform the same steps -> loops can be vectorized
+    // the mean anomalies are copied block by block, so the input may be overwritten by the output
+    constexpr size_t BLOCK_SIZE = 64;
+    float m[BLOCK_SIZE], e[BLOCK_SIZE];
+
+    for (size_t start = 0; start < n; start += BLOCK_SIZE) {
+        const size_t count = std::min(BLOCK_SIZE, n - start);
+        for (size_t i = 0; i < count; i++) {
+            m[i] = mean_anomaly[start + i];
+            e[i] = startingValue(m[i]);
+        }
+
+        for (uint32_t k = 0; k < iterations; k++) {
+            for (size_t i = 0; i < count; i++) {
+                float sin_e, cos_e;
+                math::sincos(e[i], sin_e, cos_e);
+                float f = e[i] - eccentricity * sin_e - m[i];
+                float df = 1.f - eccentricity * cos_e;
+                float ddf = eccentricity * sin_e;
+                e[i] -= f * df / (df * df - .5f * f * ddf);
+            }
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            eccentric_anomaly[start + i] = e[i];
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+double KeplerSolver::solve(const double mean_anomaly) const {
+    double e = startingValue(static_cast<float>(mean_anomaly));
+    for (uint32_t k = 0; k < 2 * MAX_ITERATIONS; k++) {
+        double f = e - eccentricity * std::sin(e) - mean_anomaly;
+        double df = 1.0 - eccentricity * std::cos(e);
+        double ddf = eccentricity * std::sin(e);
+        double step = f * df / (df * df - .5 * f * ddf);
+        e -= step;
+        if (std::abs(step) <= 1e-15) {
+            break;
+        }
+    }
+    return e;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float KeplerSolver::trueAnomaly(const float eccentric_anomaly) const {
+    // tan(v/2) = sqrt((1 + e) / (1 - e)) * tan(E/2); atan2 avoids the pole of tan at E = pi
+    float sin_half, cos_half;
+    math::sincos(.5f * eccentric_anomaly, sin_half, cos_half);
+    return 2.f * std::atan2(half_angle_factor * sin_half, cos_half);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+double KeplerSolver::trueAnomaly(const double eccentric_anomaly) const {
+    double factor = std::sqrt((1.0 + eccentricity) / (1.0 - eccentricity));
+    return 2.0 * std::atan2(factor * std::sin(.5 * eccentric_anomaly), std::cos(.5 * eccentric_anomaly));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float KeplerSolver::checkAnomaly(const uint32_t j) {
+    return static_cast<float>((j + .5) * math::TWO_PI / (TABLE_SIZE * CHECKS_PER_ENTRY));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float KeplerSolver::measureError(const std::vector<double>& reference) const {
+    float error = 0.f;
+    for (uint32_t j = 0; j < reference.size(); j++) {
+        error = std::max(error, static_cast<float>(std::abs(solve(checkAnomaly(j)) - reference[j])));
+    }
+    return error;
+}
+
+} // namespace dmsc
@@ -0,0 +1,85 @@
+#include "dmsc/line_of_sight.hpp"
+#include <algorithm>
+
+namespace dmsc {
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 64; // number of lines per output word
+
+/**
+ * @brief Checks up to 64 lines of sight and returns them as bitmask.
+ */
+inline uint64_t checkBlock(const float* x1, const float* y1, const float* z1, const float* x2, const float* y2,
+                           const float* z2, const size_t count, const float radius) {
+    const float radius_squared = radius * radius;
+    uint32_t visible[BLOCK_SIZE];
+
+    for (size_t i = 0; i < count; i++) {
+        float dx = x2[i] - x1[i];
+        float dy = y2[i] - y1[i];
+        float dz = z2[i] - z1[i];
+        float length_squared = dx * dx + dy * dy + dz * dz;
+        float dist1_squared = x1[i] * x1[i] + y1[i] * y1[i] + z1[i] * z1[i];
+        float dist2_squared = x2[i] * x2[i] + y2[i] * y2[i] + z2[i] * z2[i];
+
+        // projection of the center onto the line (scaled by length_squared): 0 at sat1, length_squared at sat2
+        float projection = -(x1[i] * dx + y1[i] * dy + z1[i] * dz);
+
+        // closest point is one of the satellites or lies in between (distance^2 * length^2 = |sat1|^2 * length^2 - p^2)
+        bool sat1_closest = projection <= 0.f;
+        bool sat2_closest = projection >= length_squared;
+        bool visible_sat1 = dist1_squared >= radius_squared;
+        bool visible_sat2 = dist2_squared >= radius_squared;
+        bool visible_line =
+            dist1_squared * length_squared - projection * projection >= radius_squared * length_squared;
+        visible[i] = sat1_closest ? visible_sat1 : (sat2_closest ? visible_sat2 : visible_line);
+    }
+
+    uint64_t mask = 0;
+    for (size_t i = 0; i < count; i++) {
+        mask |= static_cast<uint64_t>(visible[i]) << i;
+    }
+    return mask;
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+
+void checkLineOfSight(const float* x1, const float* y1, const float* z1, const float* x2, const float* y2,
+                      const float* z2, const size_t n, const float radius, uint64_t* visible) {
+    for (size_t begin = 0; begin < n; begin += BLOCK_SIZE) {
+        size_t count = std::min(BLOCK_SIZE, n - begin);
+        visible[begin / BLOCK_SIZE] =
+            checkBlock(x1 + begin, y1 + begin, z1 + begin, x2 + begin, y2 + begin, z2 + begin, count, radius);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void checkLineOfSight(const PositionBuffer& positions, const size_t offset, const std::vector<uint32_t>& from,
+                      const std::vector<uint32_t>& to, const float radius, VisibilityMask& visible) {
+    const size_t n = from.size();
+    visible.resize((n + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+    // gather the endpoints block by block
+    float x1[BLOCK_SIZE], y1[BLOCK_SIZE], z1[BLOCK_SIZE];
+    float x2[BLOCK_SIZE], y2[BLOCK_SIZE], z2[BLOCK_SIZE];
+    for (size_t begin = 0; begin < n; begin += BLOCK_SIZE) {
+        size_t count = std::min(BLOCK_SIZE, n - begin);
+        for (size_t i = 0; i < count; i++) {
+            size_t a = offset + from[begin + i];
+            size_t b = offset + to[begin + i];
+            x1[i] = positions.x[a];
+            y1[i] = positions.y[a];
+            z1[i] = positions.z[a];
+            x2[i] = positions.x[b];
+            y2[i] = positions.y[b];
+            z2[i] = positions.z[b];
+        }
+        visible[begin / BLOCK_SIZE] = checkBlock(x1, y1, z1, x2, y2, z2, count, radius);
+    }
+}
+
+} // namespace dmsc
@@ -567,6 +567,7 @@ void OpenGLWidget::recalculate() {
 
     buffer_satellite_color.values.clear();
     buffer_transformations.values.clear();
+    propagator.propagate(sim_time, satellite_positions);
     recalculateOrbitPositions();
     recalculateLines();
 
@@ -615,8 +616,7 @@ void OpenGLWidget::recalculateOrbitPositions() {
     }
 
     for (size_t i = 0; i < problem_instance.getSatellites().size(); i++) {
-        const Satellite& o = problem_instance.getSatellites()[i];
-        glm::vec3 position = o.cartesian_coordinates(sim_time) / real_world_scale;
+        glm::vec3 position = satellite_positions[i] / real_world_scale;
         glm::mat4 translation = glm::translate(position);
 
         auto result = animation.getSatelliteAnimation(i, sim_time);
@@ -644,11 +644,13 @@ void OpenGLWidget::recalculateISLNetwork() {
     }
     info->offset_vertices = buffer_lines.size();
 
+    checkLineOfSight(satellite_positions, 0, isl_from, isl_to, problem_instance.getRadiusCentralMass(), isl_visibility);
+
     Object isl_network;
     for (uint32_t i = 0; i < problem_instance.islCount(); i++) {
         const InterSatelliteLink& edge = problem_instance.getISLs().at(i);
-        glm::vec3 sat1 = edge.getV1().cartesian_coordinates(sim_time) / real_world_scale;
-        glm::vec3 sat2 = edge.getV2().cartesian_coordinates(sim_time) / real_world_scale;
+        glm::vec3 sat1 = satellite_positions[edge.getV1Idx()];
+        glm::vec3 sat2 = satellite_positions[edge.getV2Idx()];
         glm::vec4 color = glm::vec4(1.f);
 
         auto result = animation.getISLAnimation(i, sim_time);
@@ -657,14 +659,14 @@ void OpenGLWidget::recalculateISLNetwork() {
                 continue; // this isl has to be invisible rn
             color = result.second.color;
         } else {
-            if (edge.isBlocked(sim_time)) { // edge can not be scanned
+            if (!(isl_visibility[i / 64] >> (i % 64) & 1)) { // edge can not be scanned
                 color = glm::vec4(1.0f, 0.0f, 0.0f, 1.f);
             } else { // edge can be scanned
                 color = glm::vec4(0.0f, 1.0f, 0.0f, 1.f);
             }
         }
 
-        Object edge_line = OpenGLPrimitives::createLine(sat1, sat2, color);
+        Object edge_line = OpenGLPrimitives::createLine(sat1 / real_world_scale, sat2 / real_world_scale, color);
         isl_network.add(edge_line);
     }
 
@@ -695,8 +697,8 @@ void OpenGLWidget::recalculateLines() {
     if (info_arrowhead != nullptr)
         info_arrowhead->base_instance = buffer_transformations.size();
     for (const auto& c : problem_instance.scheduled_communications) {
-        glm::vec3 sat1 = problem_instance.getSatellites()[c.first].cartesian_coordinates(sim_time) / real_world_scale;
-        glm::vec3 sat2 = problem_instance.getSatellites()[c.second].cartesian_coordinates(sim_time) / real_world_scale;
+        glm::vec3 sat1 = satellite_positions[c.first] / real_world_scale;
+        glm::vec3 sat2 = satellite_positions[c.second] / real_world_scale;
         Object communication_line = OpenGLPrimitives::createLine(sat1, sat2, glm::vec4(.55f, .1f, 1.f, 1.f), true);
         scheduled_communications.add(communication_line);
 
@@ -729,7 +731,7 @@ void OpenGLWidget::recalculateLines() {
         info_arrowhead->base_instance = buffer_transformations.size(); // offset
     for (auto const& it : animation.satellite_orientations) {
         const Satellite& satellite = problem_instance.getSatellites().at(it.first);
-        glm::vec3 position = satellite.cartesian_coordinates(sim_time) / real_world_scale;
+        glm::vec3 position = satellite_positions[it.first] / real_world_scale;
         TimelineEvent<OrientationDetails> last_orientation = it.second.previousEvent(sim_time, false);
         TimelineEvent<OrientationDetails> next_orientation = it.second.prevailingEvent(sim_time, false);
 
@@ -780,7 +782,7 @@ void OpenGLWidget::recalculateLines() {
         }
 
         const Satellite& satellite = problem_instance.getSatellites().at(i);
-        glm::vec3 position = satellite.cartesian_coordinates(sim_time) / real_world_scale;
+        glm::vec3 position = satellite_positions[i] / real_world_scale;
         TimelineEvent<OrientationDetails> last_orientation = result->second.previousEvent(sim_time, false);
         TimelineEvent<OrientationDetails> next_orientation = result->second.prevailingEvent(sim_time, false);
 
@@ -836,6 +838,13 @@ void OpenGLWidget::prepareInstance(const PhysicalInstance& instance) {
     deleteInstance();
     state = INSTANCE;
     problem_instance = instance; // copy so visualization does not depend on original instance
+    propagator = ConstellationPropagator(problem_instance.getSatellites());
+    isl_from.clear();
+    isl_to.clear();
+    for (const InterSatelliteLink& isl : problem_instance.getISLs()) {
+        isl_from.push_back(isl.getV1Idx());
+        isl_to.push_back(isl.getV2Idx());
+    }
     std::vector<Object> objects;
 
     // central mass
@@ -1103,6 +1112,13 @@ void OpenGLWidget::buildGUI() {
                 if (info != nullptr)
                     info->enabled = !hide_orientations;
             }
+
+            static bool use_ephemeris = false;
+            if (ImGui::Checkbox("Ephemeris propagation", &use_ephemeris)) {
+                problem_instance.setPropagationMode(use_ephemeris ? PropagationMode::EPHEMERIS
+                                                                  : PropagationMode::EXACT);
+                propagator = ConstellationPropagator(problem_instance.getSatellites());
+            }
         }
 
         ImGui::Text("Application average %.3f ms/frame (%.1f FPS)",
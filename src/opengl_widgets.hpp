@@ -1,5 +1,7 @@
 #include "dmsc/animation.hpp"
 #include "dmsc/instance.hpp"
+#include "dmsc/line_of_sight.hpp"
+#include "dmsc/propagator.hpp"
 #include "dmsc/solution_types.hpp"
 #include "dmsc/solver.hpp" // solution data type
 #include "opengl_primitives.hpp"
@@ -85,6 +87,10 @@ class OpenGLWidget {
     std::vector<OpenGLPrimitives::ObjectInfo> scene;
     int state = VisualisationState::EMPTY;
     PhysicalInstance problem_instance = PhysicalInstance();
+    ConstellationPropagator propagator; // calculates the positions of all satellites at once
+    PositionBuffer satellite_positions; // positions at the current simulation time (not scaled)
+    std::vector<uint32_t> isl_from, isl_to; // satellite indices of all ISLs (for the batch line of sight check)
+    VisibilityMask isl_visibility;          // visibility of all ISLs at the current simulation time
     Animation animation = Animation();
     float sim_time = 0.0f;
     int sim_speed = 1;
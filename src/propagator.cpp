@@ -0,0 +1,162 @@
+#include "dmsc/propagator.hpp"
+#include "vector_math.hpp"
+#include <map>
+
+namespace dmsc {
+
+ConstellationPropagator::ConstellationPropagator(const std::vector<Satellite>& satellites) {
+    // group satellites by orbit
+    std::map<const Orbit*, uint32_t> orbit_idx;
+    std::vector<const Orbit*> orbits;
+    std::vector<uint32_t> satellite_orbit(satellites.size());
+    for (uint32_t i = 0; i < satellites.size(); i++) {
+        const Orbit* orbit = &satellites[i].getOrbit();
+        auto inserted = orbit_idx.insert({orbit, static_cast<uint32_t>(orbits.size())});
+        if (inserted.second) {
+            orbits.push_back(orbit);
+        }
+        satellite_orbit[i] = inserted.first->second;
+    }
+
+    for (uint32_t k = 0; k < orbits.size(); k++) {
+        const Orbit& orbit = *orbits[k];
+        mean_angular_speed.push_back(orbit.getMeanAngularSpeed());
+        eccentricity.push_back(orbit.getEccentricity());
+        semi_latus_rectum.push_back(orbit.getSemiLatusRectum());
+
+        const glm::vec3& p = orbit.getPerifocalP();
+        const glm::vec3& q = orbit.getPerifocalQ();
+        px.push_back(p.x);
+        py.push_back(p.y);
+        pz.push_back(p.z);
+        qx.push_back(q.x);
+        qy.push_back(q.y);
+        qz.push_back(q.z);
+
+        if (orbit.getOrbitClass() == OrbitClass::ELLIPTIC) {
+            elliptic_idx.push_back(k);
+            kepler_solvers.push_back(orbit.getKeplerSolver());
+        }
+    }
+
+    // satellites ordered by orbit (counting sort keeps the order of the satellites within an orbit)
+    orbit_begin.assign(orbits.size() + 1, 0);
+    for (uint32_t orbit : satellite_orbit) {
+        orbit_begin[orbit + 1]++;
+    }
+    for (size_t k = 0; k < orbits.size(); k++) {
+        orbit_begin[k + 1] += orbit_begin[k];
+    }
+
+    std::vector<uint32_t> next = orbit_begin;
+    satellite_idx.resize(satellites.size());
+    cos_phase.resize(satellites.size());
+    sin_phase.resize(satellites.size());
+    for (uint32_t i = 0; i < satellites.size(); i++) {
+        const Satellite& sat = satellites[i];
+        uint32_t pos = next[satellite_orbit[i]]++;
+
+        double phase = sat.getInitialMeanAnomaly();
+        satellite_idx[pos] = i;
+        cos_phase[pos] = static_cast<float>(std::cos(phase));
+        sin_phase[pos] = static_cast<float>(std::sin(phase));
+
+        if (sat.getEphemeris() != nullptr) {
+            ephemeris_idx.push_back(i);
+            ephemerides.push_back(*sat.getEphemeris());
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+ConstellationPropagator::ConstellationPropagator(const std::vector<Satellite>& satellites,
+                                                 const std::vector<uint32_t>& subset) {
+    std::vector<Satellite> selected;
+    selected.reserve(subset.size());
+    for (uint32_t idx : subset) {
+        selected.push_back(satellites.at(idx));
+    }
+    *this = ConstellationPropagator(selected);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void ConstellationPropagator::propagate(const double time, PositionBuffer& positions) const {
+    propagate(time, 0.0, 1, positions);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void ConstellationPropagator::propagate(const double t0, const double dt, const size_t samples,
+                                        PositionBuffer& positions) const {
+    const size_t n = size();
+    const size_t orbits = orbitCount();
+    positions.resize(samples * n);
+    float* x = positions.x.data();
+    float* y = positions.y.data();
+    float* z = positions.z.data();
+
+    // 1. mean anomaly of every orbit; equals the true anomaly for circular orbits
+    std::vector<float> u(samples * orbits), v(samples * orbits);
+    for (size_t s = 0; s < samples; s++) {
+        double time = t0 + static_cast<double>(s) * dt;
+        for (size_t k = 0; k < orbits; k++) {
+            u[s * orbits + k] = static_cast<float>(math::wrapAngle(mean_angular_speed[k] * time));
+        }
+    }
+
+    // 2. true anomaly of elliptic orbits (Kepler's equation is solved for all samples of an orbit at once)
+    std::vector<float> anomaly(samples);
+    for (size_t e = 0; e < elliptic_idx.size(); e++) {
+        for (size_t s = 0; s < samples; s++) {
+            anomaly[s] = u[s * orbits + elliptic_idx[e]];
+        }
+        kepler_solvers[e].solve(anomaly.data(), anomaly.data(), samples);
+        for (size_t s = 0; s < samples; s++) {
+            u[s * orbits + elliptic_idx[e]] = kepler_solvers[e].trueAnomaly(anomaly[s]);
+        }
+    }
+
+    // 3. position of every orbit in its orbital plane (u: towards the periapsis; v: 90 deg ahead)
+    for (size_t s = 0; s < samples; s++) {
+        for (size_t k = 0; k < orbits; k++) {
+            float sin_anomaly, cos_anomaly;
+            math::sincos(u[s * orbits + k], sin_anomaly, cos_anomaly);
+            float radius = semi_latus_rectum[k] / (1.f + eccentricity[k] * cos_anomaly);
+            u[s * orbits + k] = radius * cos_anomaly;
+            v[s * orbits + k] = radius * sin_anomaly;
+        }
+    }
+
+    // 4. rotate the position of the orbit by the phase of each satellite
+    for (size_t s = 0; s < samples; s++) {
+        float* x_sample = x + s * n;
+        float* y_sample = y + s * n;
+        float* z_sample = z + s * n;
+        for (size_t k = 0; k < orbits; k++) {
+            const float u_orbit = u[s * orbits + k];
+            const float v_orbit = v[s * orbits + k];
+            for (uint32_t i = orbit_begin[k]; i < orbit_begin[k + 1]; i++) {
+                float u_sat = u_orbit * cos_phase[i] - v_orbit * sin_phase[i];
+                float v_sat = v_orbit * cos_phase[i] + u_orbit * sin_phase[i];
+                x_sample[satellite_idx[i]] = u_sat * px[k] + v_sat * qx[k];
+                y_sample[satellite_idx[i]] = u_sat * py[k] + v_sat * qy[k];
+                z_sample[satellite_idx[i]] = u_sat * pz[k] + v_sat * qz[k];
+            }
+        }
+    }
+
+    // 5. approximated orbits
+    for (size_t s = 0; s < samples; s++) {
+        double time = t0 + static_cast<double>(s) * dt;
+        for (size_t e = 0; e < ephemeris_idx.size(); e++) {
+            glm::vec3 pos = ephemerides[e].evaluate(time);
+            x[s * n + ephemeris_idx[e]] = pos.x;
+            y[s * n + ephemeris_idx[e]] = pos.y;
+            z[s * n + ephemeris_idx[e]] = pos.z;
+        }
+    }
+}
+
+} // namespace dmsc
@@ -0,0 +1,121 @@
+#ifndef DMSC_ROOT_FINDING
+#define DMSC_ROOT_FINDING
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace dmsc {
+namespace math {
+
+/**
+ * @brief Finds a root of f in [a, b] with Brent's method (inverse quadratic interpolation and secant steps with
+ * bisection as fallback). f(a) and f(b) must not have the same sign.
+ *
+ * Instead of a single estimate, the final bracket is returned: first is the end where f >= 0, second the end where
+ * f < 0. The ends are at most tolerance apart, so callers can pick the side they need (e.g. the first time where a
+ * function is non-negative).
+ */
+template <typename Function>
+std::pair<double, double> findRoot(const Function& f, double a, double b, double fa, double fb, const double tolerance,
+                                   const int max_iterations = 100) {
+    double c = b, fc = fb;
+    double d = b - a, e = d;
+
+    for (int i = 0; i < max_iterations; i++) {
+        // c is the contrapoint of b (f(b) and f(c) have different signs)
+        if ((fb >= 0.0) == (fc >= 0.0)) {
+            c = a;
+            fc = fa;
+            d = e = b - a;
+        }
+        // b is the best estimate so far
+        if (std::abs(fc) < std::abs(fb)) {
+            a = b;
+            b = c;
+            c = a;
+            fa = fb;
+            fb = fc;
+            fc = fa;
+        }
+
+        double tol = .5 * tolerance;
+        double m = .5 * (c - b);
+        if (std::abs(m) <= tol || fb == 0.0) {
+            break;
+        }
+
+        if (std::abs(e) >= tol && std::abs(fa) > std::abs(fb)) {
+            // interpolation
+            double p, q, s = fb / fa;
+            if (a == c) { // secant
+                p = 2.0 * m * s;
+                q = 1.0 - s;
+            } else { // inverse quadratic interpolation
+                double r = fb / fc;
+                q = fa / fc;
+                p = s * (2.0 * m * q * (q - r) - (b - a) * (r - 1.0));
+                q = (q - 1.0) * (r - 1.0) * (s - 1.0);
+            }
+            if (p > 0.0) {
+                q = -q;
+            }
+            p = std::abs(p);
+
+            if (2.0 * p < std::min(3.0 * m * q - std::abs(tol * q), std::abs(e * q))) {
+                e = d;
+                d = p / q;
+            } else { // interpolation failed -> bisection
+                d = m;
+                e = d;
+            }
+        } else { // bounds decrease too slowly -> bisection
+            d = m;
+            e = d;
+        }
+
+        a = b;
+        fa = fb;
+        b += std::abs(d) > tol ? d : std::copysign(tol, m);
+        fb = f(b);
+    }
+
+    if ((fb >= 0.0) == (fc >= 0.0)) { // can only happen if the iteration limit was reached
+        c = a;
+        fc = fa;
+    }
+    return fb >= 0.0 ? std::make_pair(b, c) : std::make_pair(c, b);
+}
+
+/**
+ * @brief Finds the first integer x in (a, b] with f(x) >= 0. f must not change by more than max_slope per unit, so
+ * f can't be non-negative within an interval, if (f(a) + f(b) + max_slope * (b - a)) / 2 + margin < 0. Such intervals
+ * are skipped; all others are split and searched from left to right. In contrast to findRoot(), the result is exact
+ * and doesn't depend on the sign changes after it.
+ * @param margin is added to the bound to cover rounding errors of f
+ * @return x or a, if there is no such x
+ */
+template <typename Function>
+int64_t findFirstNonNegative(const Function& f, const int64_t a, const int64_t b, const double fa, const double fb,
+                             const double max_slope, const double margin) {
+    if ((fa + fb + max_slope * static_cast<double>(b - a)) / 2.0 + margin < 0.0) {
+        return a;
+    }
+    if (b - a <= 1) {
+        return fb >= 0.0 ? b : a;
+    }
+
+    int64_t m = a + (b - a) / 2;
+    double fm = f(m);
+    int64_t x = findFirstNonNegative(f, a, m, fa, fm, max_slope, margin);
+    if (x != a) {
+        return x;
+    }
+    x = findFirstNonNegative(f, m, b, fm, fb, max_slope, margin);
+    return x != m ? x : a;
+}
+
+} // namespace math
+} // namespace dmsc
+
+#endif
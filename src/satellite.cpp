@@ -1,4 +1,6 @@
 #include "dmsc/satellite.hpp"
+#include "dmsc/ephemeris.hpp"
+#include "vector_math.hpp"
 
 namespace dmsc {
 
@@ -9,71 +11,189 @@ bool StateVector::isSameOrbit(const StateVector& e) const {
 
 // ------------------------------------------------------------------------------------------------
 
-Satellite::Satellite(const StateVector sv, const CentralMass& cm)
-    : sv(sv)
-    , cm(cm) {
+Orbit::Orbit(const StateVector& sv, const CentralMass& cm)
+    : eccentricity(sv.eccentricity) {
+
+    // catch hyperbola, parabola and invalid orbits
+    if (sv.eccentricity < 0.f || sv.eccentricity >= 1.f) {
+        printf("Orbits with an eccentricity of %f can not be displayed. Eccentricity has to be in range [0,1).\n",
+               sv.eccentricity);
+        assert(false);
+        exit(EXIT_FAILURE);
+    }
+    orbit_class = sv.eccentricity == 0.f ? OrbitClass::CIRCULAR : OrbitClass::ELLIPTIC;
 
     semi_major_axis = (sv.height_perigee + cm.radius_central_mass) / (1 - sv.eccentricity);
+    semi_latus_rectum = semi_major_axis * (1 - sv.eccentricity * sv.eccentricity);
     period = 2.0f * static_cast<float>(M_PI) * sqrtf(powf(semi_major_axis, 3.0f) / cm.gravitational_parameter); // [sec]
     mean_angular_speed = (2.0f * static_cast<float>(M_PI)) / period; // [rad/sec]
+    max_speed = sqrtf(cm.gravitational_parameter / semi_latus_rectum) * (1 + sv.eccentricity); // vis-viva equation
+
+    // Equation 2.16 (MIS) split into the perifocal basis: position = r * (cos(v) * P + sin(v) * Q)
+    glm::vec3 node = glm::vec3(sinf(sv.raan), 0.f, cosf(sv.raan)); // direction of the ascending node
+    glm::vec3 normal = glm::vec3(cosf(sv.inclination) * cosf(sv.raan),
+                                 sinf(sv.inclination),
+                                 -cosf(sv.inclination) * sinf(sv.raan)); // 90 deg ahead of the node
+    perifocal_p = cosf(sv.argument_periapsis) * node + sinf(sv.argument_periapsis) * normal;
+    perifocal_q = -sinf(sv.argument_periapsis) * node + cosf(sv.argument_periapsis) * normal;
+
+    if (orbit_class == OrbitClass::ELLIPTIC) {
+        kepler = KeplerSolver(sv.eccentricity);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+Satellite::Satellite(const StateVector sv, const CentralMass& cm)
+    : sv(sv)
+    , cm(cm)
+    , orbit(std::make_shared<const Orbit>(sv, cm)) {}
+
+// ------------------------------------------------------------------------------------------------
+
+Satellite::Satellite(const StateVector sv, const CentralMass& cm, std::shared_ptr<const Orbit> orbit)
+    : sv(sv)
+    , cm(cm)
+    , orbit(std::move(orbit)) {}
+
+// ------------------------------------------------------------------------------------------------
+
+float Satellite::trueAnomaly(const float time) const {
+    if (orbit->getOrbitClass() == OrbitClass::CIRCULAR) {
+        return circularAnomaly(time);
+    }
+    return ellipticAnomaly(time);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float Satellite::circularAnomaly(const float time) const {
+    // mean and true anomaly are the same; the phase is wrapped in double precision to support large time values
+    return sv.initial_true_anomaly +
+           static_cast<float>(math::wrapAngle(double(orbit->getMeanAngularSpeed()) * time));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float Satellite::ellipticAnomaly(const float time) const {
+    const KeplerSolver& kepler = orbit->getKeplerSolver();
+    float mean_anomaly = static_cast<float>(math::wrapAngle(double(orbit->getMeanAngularSpeed()) * time)); // [rad]
+    return kepler.trueAnomaly(kepler.solve(mean_anomaly));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+template <>
+glm::vec3 Satellite::position<OrbitClass::CIRCULAR>(const float time) const {
+    float sin_anomaly, cos_anomaly;
+    math::sincos(circularAnomaly(time), sin_anomaly, cos_anomaly);
+    float a = orbit->getSemiMajorAxis();
+    return (a * cos_anomaly) * orbit->getPerifocalP() + (a * sin_anomaly) * orbit->getPerifocalQ();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+template <>
+glm::vec3 Satellite::position<OrbitClass::ELLIPTIC>(const float time) const {
+    if (ephemeris) {
+        return ephemeris->evaluate(time);
+    }
+    return cartesian_coordinates_angle(ellipticAnomaly(time));
 }
 
 // ------------------------------------------------------------------------------------------------
 
 glm::vec3 Satellite::cartesian_coordinates(const float time) const {
-    float current_true_anomaly = 0.0f;
-
-    // find true anomaly
-    if (sv.eccentricity == 0.0) { // circular orbit - easier to calculate
-        current_true_anomaly = sv.initial_true_anomaly + mean_angular_speed * time;
-    } else if (sv.eccentricity < 1.0f && sv.eccentricity > 0.0f) { // ellipse - numerical iteration needed
-        float mean_anomaly =
-            fmodf((2.0f * static_cast<float>(M_PI) / period) * time, 2.0f * static_cast<float>(M_PI)); // [rad]
-        float x = mean_anomaly;
-        float x_next;
-
-        for (int i = 0; i < 30; i++) {
-            x_next = x - ((x - sv.eccentricity * sinf(x) - mean_anomaly) / (1 - sv.eccentricity * cosf(x)));
-            if (fabsf(x_next - x) <= 0.00001f) {
-                break;
-            }
-            x = x_next;
-        }
-        current_true_anomaly =
-            2 * atanf(std::sqrt((1 + sv.eccentricity) / (1 - sv.eccentricity)) * tanf(x_next / 2.0f));
+    if (orbit->getOrbitClass() == OrbitClass::CIRCULAR) {
+        return position<OrbitClass::CIRCULAR>(time);
     }
+    return position<OrbitClass::ELLIPTIC>(time);
+}
+
+// ------------------------------------------------------------------------------------------------
 
-    return cartesian_coordinates_angle(current_true_anomaly);
+glm::dvec3 Satellite::cartesian_coordinates(const double time) const {
+    double mean_anomaly = math::wrapAngle(double(orbit->getMeanAngularSpeed()) * time); // [rad]
+    double true_anomaly = sv.initial_true_anomaly + mean_anomaly;
+    double radius = orbit->getSemiMajorAxis();
+    if (orbit->getOrbitClass() == OrbitClass::ELLIPTIC) {
+        const KeplerSolver& kepler = orbit->getKeplerSolver();
+        true_anomaly = kepler.trueAnomaly(kepler.solve(mean_anomaly));
+        radius = orbit->getSemiLatusRectum() / (1.0 + sv.eccentricity * std::cos(true_anomaly));
+    }
+    return (radius * std::cos(true_anomaly)) * glm::dvec3(orbit->getPerifocalP()) +
+           (radius * std::sin(true_anomaly)) * glm::dvec3(orbit->getPerifocalQ());
 }
 
 // ------------------------------------------------------------------------------------------------
 
 glm::vec3 Satellite::cartesian_coordinates_angle(const float true_anomaly) const {
-    glm::vec3 coords = glm::vec3(0.f);
-    float radius = 0.f;
+    float sin_anomaly, cos_anomaly;
+    math::sincos(true_anomaly, sin_anomaly, cos_anomaly);
+    float radius = orbit->getSemiLatusRectum() / (1 + sv.eccentricity * cos_anomaly);
+    return (radius * cos_anomaly) * orbit->getPerifocalP() + (radius * sin_anomaly) * orbit->getPerifocalQ();
+}
 
-    // catch hyperbola, parabola and invalid orbits
-    if (sv.eccentricity < 0.f || sv.eccentricity >= 1.f) {
-        printf("Orbits with an eccentricity of %f can not be displayed. Eccentricity has to be in range [0,1).\n",
-               sv.eccentricity);
-        assert(false);
-        exit(EXIT_FAILURE);
+// ------------------------------------------------------------------------------------------------
+
+void Satellite::setPropagationMode(const PropagationMode mode) {
+    propagation_mode = mode;
+    ephemeris.reset();
+    if (mode == PropagationMode::EPHEMERIS && orbit->getOrbitClass() == OrbitClass::ELLIPTIC) {
+        ephemeris = std::make_shared<const ChebyshevEphemeris>(*this);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+Satellite::Stepper::Stepper(const Satellite& satellite, const Tick t0, const Tick dt)
+    : satellite(&satellite)
+    , t0(t0)
+    , dt(dt) {
+    double step_angle = double(satellite.getMeanAngularSpeed()) * toSeconds(dt);
+    cos_step = std::cos(step_angle);
+    sin_step = std::sin(step_angle);
+    anchor();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Satellite::Stepper::step() {
+    steps++;
+    if (satellite->getOrbitClass() == OrbitClass::ELLIPTIC || steps % REANCHOR_INTERVAL == 0) {
+        anchor();
+        return;
     }
 
-    // potentially improves performance by avoiding the more complex equation (output would be the same)
-    if (sv.eccentricity == 0.f) {
-        radius = semi_major_axis;
-    } else {
-        radius = (semi_major_axis - semi_major_axis * sv.eccentricity * sv.eccentricity) /
-                 (1 + sv.eccentricity * cosf(true_anomaly));
+    // rotate the anomaly by one step
+    double c = cos_anomaly * cos_step - sin_anomaly * sin_step;
+    double s = sin_anomaly * cos_step + cos_anomaly * sin_step;
+    cos_anomaly = c;
+    sin_anomaly = s;
+    updateCircularPosition();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Satellite::Stepper::anchor() {
+    if (satellite->getOrbitClass() == OrbitClass::ELLIPTIC) {
+        pos = satellite->position<OrbitClass::ELLIPTIC>(static_cast<float>(toSeconds(time())));
+        return;
     }
 
-    // Equation 2.16 (MIS)
-    float rotation_angle = sv.argument_periapsis + true_anomaly;
-    coords.x = radius * (cos(rotation_angle) * sin(sv.raan) + sin(rotation_angle) * cos(sv.inclination) * cos(sv.raan));
-    coords.y = radius * (sin(rotation_angle) * sin(sv.inclination));
-    coords.z = radius * (cos(rotation_angle) * cos(sv.raan) - sin(rotation_angle) * cos(sv.inclination) * sin(sv.raan));
-    return coords;
+    double anomaly = satellite->sv.initial_true_anomaly +
+                     math::wrapAngle(double(satellite->getMeanAngularSpeed()) * toSeconds(time()));
+    cos_anomaly = std::cos(anomaly);
+    sin_anomaly = std::sin(anomaly);
+    updateCircularPosition();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Satellite::Stepper::updateCircularPosition() {
+    float a = satellite->getSemiMajorAxis();
+    pos = (a * static_cast<float>(cos_anomaly)) * satellite->getPerifocalP() +
+          (a * static_cast<float>(sin_anomaly)) * satellite->getPerifocalQ();
 }
 
 } // namespace dmsc
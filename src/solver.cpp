@@ -1,56 +1,155 @@
 #include "dmsc/solver.hpp"
 #include "dmsc/glm_include.hpp"
+#include "dmsc/line_of_sight.hpp"
+#include "root_finding.hpp"
+#include "thread_pool.hpp"
+#include "vector_math.hpp"
+#include "visibility_cache_file.hpp"
+#include <algorithm>
 #include <cmath>
 #include <ctime>
 #include <fstream>
+#include <functional>
+#include <numeric>
 #include <random>
+#include <tuple>
 
 namespace dmsc {
 
 float Solver::nextCommunication(const InterSatelliteLink& edge, const float time_0) {
+    float t_memo = findMemoizedCommunication(edge, time_0);
+    if (!std::isnan(t_memo)) {
+        return t_memo;
+    }
+
+    float t_result = nextCommunication(edge, time_0, orientationView());
+    memoizeCommunication(edge, time_0, t_result);
+    return t_result;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float Solver::findMemoizedCommunication(const InterSatelliteLink& edge, const float time_0) const {
+    uint32_t isl_idx = islIndex(edge);
+    if (!settings.communication_memo || isl_idx == ~0u) {
+        return NAN;
+    }
+
+    // there is no communication within [t_query, t_result), as long as the orientations don't change
+    const CommunicationMemo& memo = communication_memo[isl_idx];
+    bool valid = memo.version1 == orientation_version[edge.getV1Idx()] &&
+                 memo.version2 == orientation_version[edge.getV2Idx()];
+    if (!valid || !(memo.t_query <= time_0 && time_0 <= memo.t_result)) {
+        return NAN;
+    }
+    return memo.t_result;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Solver::memoizeCommunication(const InterSatelliteLink& edge, const float time_0, const float t_result) {
+    uint32_t isl_idx = islIndex(edge);
+    if (!settings.communication_memo || isl_idx == ~0u) {
+        return;
+    }
+
+    CommunicationMemo& memo = communication_memo[isl_idx];
+    memo.t_query = time_0;
+    memo.t_result = t_result;
+    memo.version1 = orientation_version[edge.getV1Idx()];
+    memo.version2 = orientation_version[edge.getV2Idx()];
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Solver::setOrientation(const uint32_t satellite_idx, const TimelineEvent<glm::vec3>& orientation) {
+    satellite_orientation[satellite_idx] = orientation;
+    orientation_version[satellite_idx]++;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Solver::clearOrientations() {
+    satellite_orientation.assign(instance.satelliteCount(), TimelineEvent<glm::vec3>());
+    orientation_version.resize(instance.satelliteCount(), 0);
+    for (uint64_t& version : orientation_version) {
+        version++;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float Solver::nextCommunication(const InterSatelliteLink& edge, const float time_0,
+                                const OrientationView orientations) const {
     // edge is never visible?
-    float t_visible = nextVisibility(edge, time_0);
-    if (t_visible >= INFINITY) {
+    Tick t0 = toTicks(time_0);
+    Tick t_visible = nextVisibilityTicks(edge, t0);
+    if (t_visible == TICK_INFINITY) {
         return INFINITY;
     }
 
-    // get current orientation of both satellites
-    TimelineEvent<glm::vec3> sat1 = satellite_orientation[&edge.getV1()];
-    TimelineEvent<glm::vec3> sat2 = satellite_orientation[&edge.getV2()];
+    // get the orientation of both satellites
+    const TimelineEvent<glm::vec3>& sat1 = orientations[edge.getV1Idx()];
+    const TimelineEvent<glm::vec3>& sat2 = orientations[edge.getV2Idx()];
+
+    // the slack is evaluated in double precision, so neighbouring ticks can be told apart
+    auto slack = [&](const Tick t) { return edge.alignmentSlack(sat1, sat2, toSeconds(t)); };
 
     // edge can be scanned directly?
-    if (edge.canAlign(sat1, sat2, t_visible)) {
-        return t_visible;
+    if (slack(t_visible) >= 0.0) {
+        return static_cast<float>(toSeconds(t_visible));
     }
 
     // satellites can't align => search for a time where they can
     // max time to align ==> time for a 180 deg turn
     float t_max = std::max(static_cast<float>(M_PI) / edge.getV1().getRotationSpeed(),
                            static_cast<float>(M_PI) / edge.getV2().getRotationSpeed());
-    t_max += edge.getPeriod();
+    Tick t_last = addTicks(t0, toTicks(t_max + edge.getPeriod()));
 
-    for (float t = t_visible; t <= time_0 + t_max; t += step_size) {
-        if (edge.isBlocked(t)) { // skip time where edge is blocked
-            // find next slot where edge is visible
-            float t_relative = fmodf(t, edge.getPeriod());
-            auto search = edge_time_slots.find(&edge);
-            float t_next = 0.0f;
+    // the line of sight turns by at most relative speed / distance [rad/sec]; the distance can shrink by at most half
+    // within (distance / 2) / relative speed seconds
+    const double relative_speed = double(edge.getV1().getMaxSpeed()) + edge.getV2().getMaxSpeed(); // [km/sec]
+    const double rotation_speed = std::min(edge.getV1().getRotationSpeed(), edge.getV2().getRotationSpeed());
+    if (rotation_speed <= 0.0) { // the satellites can't turn at all
+        return INFINITY;
+    }
+    const Tick min_step = std::max<Tick>(1, settings.boundary_tolerance);
+    const double noise = 1e-9; // [sec] rounding error of the slack
 
-            if (search != edge_time_slots.end()) {
-                t_next = search->second.nextTimeWithEvent(t_relative, true);
-            }
+    // sample the slack within the visibility windows until it becomes non-negative
+    for (Tick t_window = t_visible; t_window <= t_last; t_window = nextVisibilityTicks(edge, t_window)) {
+        Tick t_prev = t_window;
+        double s_prev = slack(t_prev);
+        if (s_prev >= 0.0) { // aligned at the begin of the window
+            return static_cast<float>(toSeconds(t_prev));
+        }
+
+        // last visible time of the window; at least t_window, so the next window is searched after it
+        Tick t_end = std::max(t_window, std::min(nextBlockedTicks(edge, t_window), addTicks(t_last, 1)) - 1);
+        while (t_prev < t_end) {
+            // the slack grows by at most max_growth [sec/sec], so it can't reach 0 within -s_prev / max_growth seconds
+            float time = static_cast<float>(toSeconds(t_prev));
+            double distance =
+                glm::length(edge.getV2().cartesian_coordinates(time) - edge.getV1().cartesian_coordinates(time));
+            double max_growth = 1.0 + 2.0 * relative_speed / (distance * rotation_speed);
+            double safe_time = std::min(-s_prev / max_growth, 0.5 * distance / relative_speed);
+            Tick t = std::min(addTicks(t_prev, std::max(toTicks(safe_time), min_step)), t_end);
+            double s = slack(t);
 
-            if (t_next < t_relative) { // loop applied
-                t += t_next + edge.getPeriod() - t_relative;
-            } else { // loop not applied
-                t += t_next - t_relative;
+            // first aligned tick within (t_prev, t]; ticks are only skipped if the bound proves that they are not
+            // aligned, so the result doesn't depend on where the search started (see CommunicationMemo)
+            Tick t_aligned =
+                math::findFirstNonNegative(slack, t_prev, t, s_prev, s, max_growth / TICKS_PER_SECOND, noise);
+            if (t_aligned != t_prev) {
+                return static_cast<float>(toSeconds(t_aligned));
             }
+            t_prev = t;
+            s_prev = s;
         }
 
-        if (edge.canAlign(sat1, sat2, t)) { // edge can be scanned
-            if (!edge.isBlocked(t)) {
-                return t;
-            }
+        t_window = t_end + 1;
+        if (t_window > t_last) {
+            break;
         }
     }
 
@@ -61,66 +160,701 @@ float Solver::nextCommunication(const InterSatelliteLink& edge, const float time
 // ------------------------------------------------------------------------------------------------
 
 void Solver::createCache() {
+    // edges are equivalent, if their satellites use the same orbits and have the same phase difference
+    using ClassKey = std::tuple<const Orbit*, const Orbit*, int64_t>;
+    std::map<ClassKey, uint32_t> class_idx;
+    const int64_t full_circle = std::llround(math::TWO_PI / PHASE_RESOLUTION);
+
+    edge_views.reserve(instance.islCount());
+    communication_memo.resize(instance.islCount());
+    if (settings.visibility_store == VisibilityStore::BITMAP) {
+        edge_bitmaps.resize(instance.islCount());
+    }
     for (const auto& edge : instance.getISLs()) {
-        for (float t = 0.0f; t < edge.getPeriod(); t += step_size) {
-            // TODO getPERIOD IS INFINIT if cm.gp = 0
-            float t_next = findNextVisiblity(edge, t);
-            if (t_next == INFINITY || t_next >= edge.getPeriod()) {
-                break;
+        const Satellite& v1 = edge.getV1();
+        const Satellite& v2 = edge.getV2();
+
+        // time-shifted copies only exist, if both satellites move with the same speed and repeat within the horizon
+        if (v1.getSemiMajorAxis() == v2.getSemiMajorAxis() && edge.isPeriodic()) {
+            double phase_difference = math::wrapAngle(double(v2.getInitialMeanAnomaly()) - v1.getInitialMeanAnomaly());
+            int64_t quantized_phase = std::llround(phase_difference / PHASE_RESOLUTION) % full_circle;
+            ClassKey key(&v1.getOrbit(), &v2.getOrbit(), quantized_phase);
+
+            auto inserted = class_idx.insert({key, static_cast<uint32_t>(visibility_classes.size())});
+            if (!inserted.second) {
+                // the representative reaches the current phase of this edge after offset seconds
+                const Satellite& representative = visibility_classes[inserted.first->second].representative->getV1();
+                double phase_shift =
+                    math::wrapAngle(double(v1.getInitialMeanAnomaly()) - representative.getInitialMeanAnomaly());
+                Tick offset = toTicks(phase_shift / v1.getMeanAngularSpeed()) % edge.getPeriodTicks();
+                edge_views.push_back({inserted.first->second, offset});
+                continue;
             }
+        }
 
-            float t_end = findLastVisible(edge, t_next);
-            if (t_end == INFINITY || t_end >= edge.getPeriod()) {
-                t_end = edge.getPeriod();
+        edge_views.push_back({static_cast<uint32_t>(visibility_classes.size()), 0});
+        VisibilityClass visibility_class;
+        visibility_class.representative = &edge;
+        if (edge.getVisibility() != EdgeVisibility::VARIES) { // known without a sweep
+            if (edge.getVisibility() == EdgeVisibility::ALWAYS) {
+                appendWindow(visibility_class.windows, 0, edge.getPeriodTicks());
             }
+            visibility_class.progress = edge.getPeriodTicks();
+        }
+        visibility_classes.push_back(visibility_class);
+    }
+    std::vector<uint32_t> all_classes(visibility_classes.size());
+    std::iota(all_classes.begin(), all_classes.end(), 0u);
+
+    if (!settings.cache_file.empty()) {
+        uint64_t fingerprint = cacheFingerprint();
+        VisibilityCacheFile file(settings.cache_file, fingerprint);
+        if (file.isValid() && file.edgeCount() == visibility_classes.size()) {
+            for (size_t i = 0; i < visibility_classes.size(); i++) {
+                VisibilityClass& visibility_class = visibility_classes[i];
+                visibility_class.windows.assign(file.begin(i), file.end(i));
+                visibility_class.progress = visibility_class.representative->getPeriodTicks();
+            }
+            return;
+        }
 
-            TimelineEvent<> slot(t_next, t_end);
-            edge_time_slots[&edge].insert(slot);
-            t = slot.t_end;
+        computeVisibilityWindows(all_classes);
+        std::vector<const std::vector<TimeWindow>*> windows;
+        for (const VisibilityClass& visibility_class : visibility_classes) {
+            windows.push_back(&visibility_class.windows);
         }
+        if (!VisibilityCacheFile::save(settings.cache_file, fingerprint, windows)) {
+            printf("Could not write visibility cache %s.\n", settings.cache_file.c_str());
+        }
+        return;
+    }
+
+    // calculate all windows at once
+    if (!settings.lazy_cache) {
+        computeVisibilityWindows(all_classes);
     }
 }
 
 // ------------------------------------------------------------------------------------------------
 
-float Solver::nextVisibility(const InterSatelliteLink& edge, const float t0) {
-    if (edge_time_slots[&edge].size() == 0) {
-        return INFINITY;
+void Solver::completeCache() {
+    std::vector<uint32_t> isl_indices(instance.islCount());
+    std::iota(isl_indices.begin(), isl_indices.end(), 0u);
+    completeCache(isl_indices);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Solver::completeCache(const std::vector<uint32_t>& isl_indices) {
+    // classes of the given edges (in the order of their index)
+    std::vector<bool> selected(visibility_classes.size(), false);
+    for (uint32_t isl_idx : isl_indices) {
+        selected[edge_views[isl_idx].class_idx] = true;
+    }
+    std::vector<uint32_t> classes;
+    for (uint32_t i = 0; i < visibility_classes.size(); i++) {
+        if (selected[i]) {
+            classes.push_back(i);
+        }
+    }
+    computeVisibilityWindows(classes);
+
+    // classes that were partially sampled by lazy queries are finished one by one
+    for (uint32_t i : classes) {
+        while (visibility_classes[i].progress < visibility_classes[i].representative->getPeriodTicks()) {
+            extendVisibilityWindows(i, TICK_INFINITY);
+        }
+    }
+
+    if (settings.visibility_store == VisibilityStore::BITMAP) {
+        ThreadPool pool(settings.threads);
+        pool.parallelFor(isl_indices.size(), [&](const size_t i) { visibilityBitmap(isl_indices[i]); });
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+uint64_t Solver::cacheFingerprint() const {
+    Fingerprint fingerprint;
+    fingerprint.add(instance.getRadiusCentralMass());
+    for (const Satellite& satellite : instance.getSatellites()) {
+        fingerprint.add(satellite.getPeriod()); // depends on the gravitational parameter
+        fingerprint.add(satellite.getHeightPerigee());
+        fingerprint.add(satellite.getEccentricity());
+        fingerprint.add(satellite.getInclination());
+        fingerprint.add(satellite.getArgumentPeriapsis());
+        fingerprint.add(satellite.getRaan());
+        fingerprint.add(satellite.getTrueAnomaly());
+        fingerprint.add(satellite.getPropagationMode());
+    }
+    for (const InterSatelliteLink& edge : instance.getISLs()) {
+        fingerprint.add(edge.getV1Idx());
+        fingerprint.add(edge.getV2Idx());
+        fingerprint.add(edge.getPeriodTicks());
+        fingerprint.add(edge.isPeriodic());
+    }
+    fingerprint.add(step_size);
+    fingerprint.add(settings.visibility_sweep);
+    fingerprint.add(settings.bracket_step);
+    fingerprint.add(settings.boundary_tolerance);
+    fingerprint.add(settings.coarse_step);
+    return fingerprint.value();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+std::vector<TimeWindow> Solver::findVisibilityWindowsAdaptive(const InterSatelliteLink& edge) const {
+    std::vector<TimeWindow> windows;
+    Tick period = edge.getPeriodTicks();
+    ConstellationPropagator propagator(instance.getSatellites(), {edge.getV1Idx(), edge.getV2Idx()});
+    for (Tick t = 0; t < period; t += step_size) {
+        // TODO getPERIOD IS INFINIT if cm.gp = 0
+        Tick t_next = findNextVisiblity(edge, t, propagator);
+        if (t_next == TICK_INFINITY || t_next >= period) {
+            break;
+        }
+
+        Tick t_end = findLastVisible(edge, t_next, propagator);
+        if (t_end == TICK_INFINITY || t_end >= period) {
+            t_end = period;
+        }
+
+        appendWindow(windows, t_next, t_end);
+        t = t_end;
+    }
+    return windows;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+std::vector<TimeWindow> Solver::findVisibilityWindowsBisection(const InterSatelliteLink& edge) const {
+    std::vector<TimeWindow> windows;
+    const Tick period = edge.getPeriodTicks();
+    const Tick tolerance = std::max<Tick>(1, settings.boundary_tolerance);
+    const double speed = std::max(edge.getV1().getMaxSpeed(), edge.getV2().getMaxSpeed()); // [km/sec]
+    auto clearance = [&edge](const Tick t) { return edge.clearance(toSeconds(t)); };
+
+    Tick t_prev = 0;
+    double c_prev = clearance(0);
+    Tick window_begin = c_prev >= 0.0 ? 0 : TICK_INFINITY;
+
+    // searches all boundaries in (a, b]
+    std::function<void(Tick, double, Tick, double)> refine = [&](Tick a, double c_a, Tick b, double c_b) {
+        const bool sign_change = (c_a >= 0.0) != (c_b >= 0.0);
+
+        // the clearance changes by at most speed * (b - a), so the clearance at both ends can prove that the
+        // visibility doesn't change in between
+        double margin = speed * toSeconds(b - a);
+        if (!sign_change && (c_a >= 0.0 ? c_a + c_b >= margin : c_a + c_b + margin < 0.0)) {
+            return;
+        }
+
+        // a sign change can hide further windows or gaps, so it is only resolved at the tolerance; windows and gaps
+        // that are shorter than the tolerance are ignored
+        if (b - a <= tolerance) {
+            if (!sign_change) {
+                return;
+            }
+            if (c_b >= 0.0) { // window begins; first visible time
+                window_begin = b;
+            } else { // window ends; last visible time
+                appendWindow(windows, window_begin, a);
+                window_begin = TICK_INFINITY;
+            }
+            return;
+        }
+
+        // the left half is searched first, so the windows are found in order
+        Tick m = a + (b - a) / 2;
+        double c_m = clearance(m);
+        refine(a, c_a, m, c_m);
+        refine(m, c_m, b, c_b);
+    };
+
+    while (t_prev < period) {
+        Tick t = std::min(addTicks(t_prev, settings.coarse_step), period);
+        double c = clearance(t);
+        refine(t_prev, c_prev, t, c);
+        t_prev = t;
+        c_prev = c;
+    }
+
+    // window reaches the end of the period
+    if (window_begin != TICK_INFINITY) {
+        appendWindow(windows, window_begin, period);
+    }
+    return windows;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Solver::extendVisibilityWindows(const uint32_t class_idx, const Tick t_end) const {
+    VisibilityClass& visibility_class = visibility_classes[class_idx];
+    switch (settings.visibility_sweep) {
+    case VisibilitySweep::RASTER:
+    case VisibilitySweep::ROOT_FINDING: {
+        const bool refine = settings.visibility_sweep == VisibilitySweep::ROOT_FINDING;
+        const Tick step = refine ? settings.bracket_step : step_size;
+        const Tick t_begin = visibility_class.progress < 0 ? 0 : visibility_class.progress + step;
+        // at least one sample is taken, so lazy queries make progress even if cache_chunk is shorter than the step
+        sweepVisibilityWindows({&visibility_class}, t_begin, std::max(t_begin, t_end), step, refine);
+        break;
+    }
+    case VisibilitySweep::ADAPTIVE:
+        visibility_class.windows = findVisibilityWindowsAdaptive(*visibility_class.representative);
+        visibility_class.progress = visibility_class.representative->getPeriodTicks();
+        break;
+    case VisibilitySweep::BISECTION:
+        visibility_class.windows = findVisibilityWindowsBisection(*visibility_class.representative);
+        visibility_class.progress = visibility_class.representative->getPeriodTicks();
+        break;
+    default:
+        printf("Unknown visibility sweep.\n");
+        assert(false);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Solver::computeVisibilityWindows(const std::vector<uint32_t>& classes) {
+    // classes that were classified analytically (or sampled by lazy queries) are not swept
+    std::vector<uint32_t> order;
+    for (uint32_t i : classes) {
+        if (visibility_classes[i].progress < 0) {
+            order.push_back(i);
+        }
+    }
+    if (order.empty()) {
+        return;
+    }
+    ThreadPool pool(settings.threads);
+
+    // these modes are not sliced; each class is a task
+    if (settings.visibility_sweep == VisibilitySweep::ADAPTIVE ||
+        settings.visibility_sweep == VisibilitySweep::BISECTION) {
+        pool.parallelFor(order.size(), [&](const size_t i) { extendVisibilityWindows(order[i], TICK_INFINITY); });
+        return;
+    }
+
+    const bool refine = settings.visibility_sweep == VisibilitySweep::ROOT_FINDING;
+    const Tick step = refine ? settings.bracket_step : step_size;
+    const Tick slice = std::max(step, settings.cache_chunk / step * step);
+    auto lastSample = [&](const uint32_t class_idx) { // first sample after the period
+        Tick period = visibility_classes[class_idx].representative->getPeriodTicks();
+        return (period + step - 1) / step * step;
+    };
+
+    // the classes are swept in groups of 64 (one word of the line of sight kernel) with similar periods and split into
+    // time slices; a slice begins with the last sample of the previous one
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return lastSample(a) < lastSample(b); });
+
+    struct Task {
+        size_t group_begin; // position in order
+        size_t group_end;
+        Tick slice_idx;
+        std::vector<uint32_t> classes;
+        std::vector<VisibilityClass> parts; // windows of the classes within the slice
+    };
+    std::vector<Task> tasks;
+    for (size_t begin = 0; begin < order.size(); begin += 64) {
+        size_t end = std::min(begin + 64, order.size());
+        for (Tick k = 0; k <= lastSample(order[end - 1]) / slice; k++) {
+            tasks.push_back({begin, end, k, {}, {}});
+        }
+    }
+
+    pool.parallelFor(tasks.size(), [&](const size_t i) {
+        Task& task = tasks[i];
+        for (size_t j = task.group_begin; j < task.group_end; j++) {
+            if (lastSample(order[j]) >= task.slice_idx * slice) {
+                VisibilityClass part;
+                part.representative = visibility_classes[order[j]].representative;
+                task.classes.push_back(order[j]);
+                task.parts.push_back(part);
+            }
+        }
+
+        std::vector<VisibilityClass*> parts;
+        for (VisibilityClass& part : task.parts) {
+            parts.push_back(&part);
+        }
+        Tick t_begin = std::max<Tick>(0, task.slice_idx * slice - step);
+        sweepVisibilityWindows(parts, t_begin, (task.slice_idx + 1) * slice - step, step, refine);
+    });
+
+    // merge the slices in the order of time; a window that is open at the end of a slice continues at the first sample
+    // of the next one
+    for (Task& task : tasks) {
+        Tick t_begin = task.slice_idx * slice - step;
+        for (size_t j = 0; j < task.classes.size(); j++) {
+            VisibilityClass& visibility_class = visibility_classes[task.classes[j]];
+            const VisibilityClass& part = task.parts[j];
+            if (task.slice_idx == 0) {
+                visibility_class = part;
+                continue;
+            }
+
+            Tick open_window = visibility_class.window_begin;
+            for (TimeWindow window : part.windows) {
+                if (open_window != TICK_INFINITY && window.t_begin == t_begin) {
+                    window.t_begin = open_window;
+                }
+                open_window = TICK_INFINITY;
+                appendWindow(visibility_class.windows, window.t_begin, window.t_end);
+            }
+
+            if (part.window_begin == t_begin && open_window != TICK_INFINITY) {
+                visibility_class.window_begin = open_window;
+            } else {
+                visibility_class.window_begin = part.window_begin;
+            }
+            visibility_class.progress = part.progress;
+        }
     }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Solver::sweepVisibilityWindows(const std::vector<VisibilityClass*>& classes, const Tick t_begin,
+                                    const Tick t_end, const Tick step, const bool refine) const {
+    const Tick samples = 64; // time samples per propagation
+    const double tolerance = toSeconds(settings.boundary_tolerance);
+
+    // adds the boundary of a window that lies in (t_prev, t]
+    auto addBoundary = [&](VisibilityClass& visibility_class, const Tick t_prev, const Tick t, const bool visible) {
+        Tick t_boundary = visible ? t : t_prev; // first / last visible raster point
+        if (refine) {
+            const InterSatelliteLink& edge = *visibility_class.representative;
+            auto clearance = [&edge](const double t) { return edge.clearance(t); };
+            double c_prev = clearance(toSeconds(t_prev));
+            double c = clearance(toSeconds(t));
+            // the sampled sign might differ from the exact one, if the clearance is close to zero
+            if ((c >= 0.0) == visible && (c_prev >= 0.0) != visible) {
+                auto bracket = math::findRoot(clearance, toSeconds(t_prev), toSeconds(t), c_prev, c, tolerance);
+                if (visible) { // window begins; first visible time
+                    t_boundary = std::min(static_cast<Tick>(std::ceil(bracket.first * TICKS_PER_SECOND)), t);
+                } else { // window ends; last visible time
+                    t_boundary = std::max(static_cast<Tick>(std::floor(bracket.first * TICKS_PER_SECOND)), t_prev);
+                }
+            }
+        }
+
+        if (visible) {
+            visibility_class.window_begin = t_boundary;
+        } else {
+            appendWindow(visibility_class.windows, visibility_class.window_begin, t_boundary);
+            visibility_class.window_begin = TICK_INFINITY;
+        }
+    };
 
-    float t = std::fmod(t0, edge.getPeriod());
-    float n_periods = edge.getPeriod() * (int)(t0 / edge.getPeriod());
+    // classes that are still sampled, ordered by period
+    std::vector<VisibilityClass*> active(classes);
+    std::sort(active.begin(), active.end(), [](const VisibilityClass* a, const VisibilityClass* b) {
+        return a->representative->getPeriodTicks() < b->representative->getPeriodTicks();
+    });
 
-    float t_next = edge_time_slots[&edge].nextTimeWithEvent(t, true);
-    if (t_next < t) { // loop applied
-        n_periods += edge.getPeriod();
+    // only the satellites of the swept edges are propagated
+    std::vector<uint32_t> subset;
+    std::map<uint32_t, uint32_t> local_idx; // index in the instance -> index in subset
+    auto localIndex = [&](const uint32_t idx) {
+        auto inserted = local_idx.insert({idx, static_cast<uint32_t>(subset.size())});
+        if (inserted.second) {
+            subset.push_back(idx);
+        }
+        return inserted.first->second;
+    };
+    std::vector<uint32_t> from, to;
+    for (const VisibilityClass* visibility_class : active) {
+        from.push_back(localIndex(visibility_class->representative->getV1Idx()));
+        to.push_back(localIndex(visibility_class->representative->getV2Idx()));
     }
 
-    return t_next + n_periods;
+    // blocks begin at multiples of 64 samples, so a sample always has the same value (independent of t_begin)
+    ConstellationPropagator propagator(instance.getSatellites(), subset);
+    PositionBuffer positions;
+    VisibilityMask visible;
+    for (Tick t0 = t_begin - t_begin % (samples * step); !active.empty() && t0 <= t_end;
+         t0 = addTicks(t0, samples * step)) {
+        propagator.propagate(toSeconds(t0), toSeconds(step), samples, positions);
+        for (Tick s = 0; s < samples && !active.empty(); s++) {
+            Tick t = t0 + s * step;
+            if (t < t_begin) {
+                continue;
+            } else if (t > t_end) {
+                break;
+            }
+            checkLineOfSight(positions, s * subset.size(), from, to, instance.getRadiusCentralMass(), visible);
+
+            size_t n_expired = 0;
+            for (size_t k = 0; k < active.size(); k++) {
+                VisibilityClass& visibility_class = *active[k];
+                const InterSatelliteLink& edge = *visibility_class.representative;
+                bool is_visible = visible[k / 64] >> (k % 64) & 1;
+                bool was_visible = visibility_class.window_begin != TICK_INFINITY;
+                Tick end = edge.getPeriodTicks();
+
+                if (visibility_class.progress < 0) { // first sample
+                    visibility_class.window_begin = is_visible ? t : TICK_INFINITY;
+                } else if (t < end) {
+                    if (is_visible != was_visible) {
+                        addBoundary(visibility_class, t - step, t, is_visible);
+                    }
+                } else { // first sample after the period; close the last window
+                    if (refine) {
+                        bool visible_at_end = edge.clearance(toSeconds(end)) >= 0.0;
+                        if (visible_at_end != was_visible) {
+                            addBoundary(visibility_class, t - step, end, visible_at_end);
+                        }
+                        if (visibility_class.window_begin != TICK_INFINITY) {
+                            appendWindow(visibility_class.windows, visibility_class.window_begin, end);
+                        }
+                    } else if (was_visible) {
+                        Tick t_last = is_visible ? end : t - step;
+                        appendWindow(visibility_class.windows, visibility_class.window_begin, t_last);
+                    }
+                    visibility_class.window_begin = TICK_INFINITY;
+                    visibility_class.progress = end;
+                    n_expired++;
+                    continue;
+                }
+                visibility_class.progress = t;
+            }
+
+            // expired classes are at the beginning, because the classes are ordered by period
+            if (n_expired > 0) {
+                active.erase(active.begin(), active.begin() + n_expired);
+                from.erase(from.begin(), from.begin() + n_expired);
+                to.erase(to.begin(), to.begin() + n_expired);
+            }
+        }
+    }
 }
 
 // ------------------------------------------------------------------------------------------------
 
-float Solver::findNextVisiblity(const InterSatelliteLink& edge, const float t0) const {
-    for (float t = t0; t <= t0 + edge.getPeriod(); t += step_size) {
-        if (!edge.isBlocked(t)) {
+Tick Solver::findCachedVisibility(const uint32_t class_idx, const Tick t) const {
+    const VisibilityClass& visibility_class = visibility_classes[class_idx];
+    const Tick period = visibility_class.representative->getPeriodTicks();
+
+    while (true) {
+        Tick t_next = nextTimeInWindows(visibility_class.windows, t);
+        if (t_next != TICK_INFINITY) { // closed window
+            return t_next;
+        }
+        // open window; its end isn't active (see findWindow()), so a query at the last sample waits for the sweep
+        const Tick window_begin = visibility_class.window_begin;
+        if (window_begin != TICK_INFINITY && (t < visibility_class.progress || t == window_begin)) {
+            return std::max(t, window_begin);
+        }
+        if (visibility_class.progress >= period) { // all windows are known
+            return TICK_INFINITY;
+        }
+        extendVisibilityWindows(class_idx, addTicks(std::max(t, visibility_class.progress), settings.cache_chunk));
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+Tick Solver::findCachedWindowEnd(const uint32_t class_idx, const Tick t) const {
+    const VisibilityClass& visibility_class = visibility_classes[class_idx];
+    const Tick period = visibility_class.representative->getPeriodTicks();
+
+    while (true) {
+        auto window = findWindow(visibility_class.windows, t);
+        if (window != visibility_class.windows.end() && window->t_begin <= t) { // closed window
+            return window->t_end;
+        }
+        if (visibility_class.progress >= period) { // not visible at all
             return t;
         }
+        extendVisibilityWindows(class_idx, addTicks(visibility_class.progress, settings.cache_chunk));
     }
-    // edge is never visible
-    return INFINITY;
 }
 
 // ------------------------------------------------------------------------------------------------
 
-float Solver::findLastVisible(const InterSatelliteLink& edge, const float t0) const {
-    for (float t = t0; t <= t0 + edge.getPeriod(); t += step_size) {
-        if (edge.isBlocked(t)) {
-            return t - step_size;
+float Solver::nextVisibility(const InterSatelliteLink& edge, const float t0) const {
+    return static_cast<float>(toSeconds(nextVisibilityTicks(edge, toTicks(t0))));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+Tick Solver::nextVisibilityTicks(const InterSatelliteLink& edge, const Tick t0) const {
+    uint32_t isl_idx = islIndex(edge);
+    if (isl_idx == ~0u) {
+        return TICK_INFINITY;
+    }
+
+    if (settings.visibility_store == VisibilityStore::BITMAP) {
+        return findBitmapVisibility(isl_idx, t0);
+    }
+
+    // search in the windows of the class representative
+    uint32_t class_idx = edge_views[isl_idx].class_idx;
+    Tick offset = edge_views[isl_idx].offset;
+    Tick period = edge.getPeriodTicks();
+    Tick horizon = edge.getHorizonTicks();
+
+    // windows of aperiodic edges are only known within the planning horizon
+    if (t0 >= horizon) {
+        return TICK_INFINITY;
+    } else if (!edge.isPeriodic()) {
+        return findCachedVisibility(class_idx, t0);
+    }
+
+    Tick t_shifted = t0 + offset;
+    Tick t = t_shifted % period;
+    Tick n_periods = t_shifted - t;
+
+    Tick t_next = findCachedVisibility(class_idx, t);
+    if (t_next == TICK_INFINITY) { // loop applied
+        t_next = findCachedVisibility(class_idx, 0);
+        if (t_next == TICK_INFINITY) { // never visible
+            return TICK_INFINITY;
+        }
+        n_periods += period;
+    }
+
+    // approximate periods are only repeated within the planning horizon
+    t_next += n_periods - offset;
+    return t_next < horizon ? t_next : TICK_INFINITY;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+Tick Solver::nextBlockedTicks(const InterSatelliteLink& edge, const Tick t0) const {
+    if (nextVisibilityTicks(edge, t0) != t0) {
+        return t0;
+    }
+
+    // the edge is visible at t0, so it can't be blocked before t0 + 1 (e.g. a window [t0, t0] ends at t0)
+    const uint32_t isl_idx = islIndex(edge);
+    const Tick period = edge.getPeriodTicks();
+    if (settings.visibility_store == VisibilityStore::BITMAP) {
+        // t0 is a visible raster point; the window ends at the next clear bit
+        const std::vector<uint64_t>& bitmap = visibilityBitmap(isl_idx);
+        Tick n_periods = edge.isPeriodic() ? t0 / period * period : 0;
+        size_t bit = math::findNextSetBit(bitmap.data(), bitmap.size(), (t0 - n_periods) / step_size, ~uint64_t(0));
+        Tick t_end = n_periods + std::min(static_cast<Tick>(bit) * step_size, period);
+        return std::max(t0 + 1, std::min(t_end, edge.getHorizonTicks()));
+    }
+
+    Tick offset = edge_views[isl_idx].offset;
+    Tick t_shifted = t0 + offset;
+    Tick t = edge.isPeriodic() ? t_shifted % period : t_shifted;
+    Tick t_end = findCachedWindowEnd(edge_views[isl_idx].class_idx, t) + (t_shifted - t) - offset;
+    return std::max(t0 + 1, std::min(t_end, edge.getHorizonTicks()));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+Tick Solver::findBitmapVisibility(const uint32_t isl_idx, const Tick t0) const {
+    const InterSatelliteLink& edge = instance.getISLs()[isl_idx];
+    const std::vector<uint64_t>& bitmap = visibilityBitmap(isl_idx);
+    const size_t n_bits = 64 * bitmap.size();
+    Tick period = edge.getPeriodTicks();
+    Tick horizon = edge.getHorizonTicks();
+    if (t0 >= horizon) {
+        return TICK_INFINITY;
+    }
+
+    // first raster point >= t0 within the current period
+    Tick n_periods = edge.isPeriodic() ? t0 / period * period : 0;
+    size_t bit = math::findNextSetBit(bitmap.data(), bitmap.size(), (t0 - n_periods + step_size - 1) / step_size);
+    if (bit == n_bits) { // loop applied
+        bit = edge.isPeriodic() ? math::findNextSetBit(bitmap.data(), bitmap.size(), 0) : n_bits;
+        if (bit == n_bits) {
+            return TICK_INFINITY;
         }
+        n_periods += period;
     }
-    // edge is never visible
-    return INFINITY;
+    Tick t_next = n_periods + static_cast<Tick>(bit) * step_size;
+    return t_next < horizon ? t_next : TICK_INFINITY;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const std::vector<uint64_t>& Solver::visibilityBitmap(const uint32_t isl_idx) const {
+    std::vector<uint64_t>& bitmap = edge_bitmaps[isl_idx];
+    if (!bitmap.empty()) {
+        return bitmap;
+    }
+
+    // all windows of the class are needed
+    const VisibilityView& view = edge_views[isl_idx];
+    VisibilityClass& visibility_class = visibility_classes[view.class_idx];
+    const Tick period = visibility_class.representative->getPeriodTicks();
+    while (visibility_class.progress < period) {
+        extendVisibilityWindows(view.class_idx, TICK_INFINITY);
+    }
+
+    // the edge is visible at time t, iff the class is visible at t + offset
+    const size_t n_bits = static_cast<size_t>((period + step_size - 1) / step_size);
+    bitmap.assign((n_bits + 63) / 64, 0);
+    for (size_t k = 0; k < n_bits; k++) {
+        Tick t = (static_cast<Tick>(k) * step_size + view.offset) % period;
+        if (nextTimeInWindows(visibility_class.windows, t) == t) {
+            bitmap[k / 64] |= uint64_t(1) << (k % 64);
+        }
+    }
+    return bitmap;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+uint32_t Solver::islIndex(const InterSatelliteLink& edge) const {
+    const std::vector<InterSatelliteLink>& isls = instance.getISLs();
+    std::less<const InterSatelliteLink*> less; // total order, even for pointers into other arrays
+    if (isls.empty() || less(&edge, isls.data()) || !less(&edge, isls.data() + isls.size())) {
+        return ~0u;
+    }
+    return static_cast<uint32_t>(&edge - isls.data());
+}
+
+// ------------------------------------------------------------------------------------------------
+
+Tick Solver::findNextVisiblity(const InterSatelliteLink& edge, const Tick t0,
+                               const ConstellationPropagator& propagator) const {
+    return findRasterTime(edge, t0, true, propagator);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+Tick Solver::findLastVisible(const InterSatelliteLink& edge, const Tick t0,
+                             const ConstellationPropagator& propagator) const {
+    Tick t_blocked = findRasterTime(edge, t0, false, propagator);
+    if (t_blocked == TICK_INFINITY) { // edge is never blocked
+        return TICK_INFINITY;
+    }
+    return t_blocked - step_size;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+Tick Solver::findRasterTime(const InterSatelliteLink& edge, const Tick t0, const bool visible,
+                            const ConstellationPropagator& propagator) const {
+    Tick t_last = addTicks(t0, edge.getPeriodTicks());
+
+    // max. change of the clearance per tick
+    double speed = std::max(edge.getV1().getMaxSpeed(), edge.getV2().getMaxSpeed()) / double(TICKS_PER_SECOND);
+    PositionBuffer positions;
+    VisibilityMask mask;
+    for (Tick t = t0; t <= t_last;) {
+        // same check as in sweepVisibilityWindows()
+        propagator.propagate(toSeconds(t), positions);
+        checkLineOfSight(positions, 0, {0}, {1}, edge.getRadiusCentralMass(), mask);
+        if (static_cast<bool>(mask[0] & 1) == visible) {
+            return t;
+        }
+
+        // the visibility doesn't change on all raster points that are closer than |clearance| / speed; the margin
+        // covers the rounding errors of both checks
+        double clearance = std::abs(edge.clearance(toSeconds(t))) - InterSatelliteLink::CLASSIFICATION_MARGIN;
+        Tick safe_ticks = static_cast<Tick>(std::max(0.0, clearance) / speed);
+        t = addTicks(t, std::max<Tick>(1, safe_ticks / step_size) * step_size);
+    }
+    return TICK_INFINITY;
 }
 
 } // namespace dmsc
@@ -1,4 +1,6 @@
 #include "dmsc/solver/greedy_next.hpp"
+#include "indexed_heap.hpp"
+#include "thread_pool.hpp"
 #include <chrono>
 
 namespace dmsc {
@@ -13,50 +15,71 @@ DmscSolution GreedyNext::solve() {
     // init variables
     ScanCover scan_cover;
     float curr_time = 0.0;
-    satellite_orientation.clear();
+    clearOrientations();
 
-    // select edges for computation
-    std::vector<const InterSatelliteLink*> remaining_edges;
-    for (const InterSatelliteLink& e : instance.getISLs()) {
-        float t_communication = nextCommunication(e, 0.0f);
-        if (t_communication < INFINITY) {
-            remaining_edges.push_back(&e);
-        }
+    const std::vector<InterSatelliteLink>& isls = instance.getISLs();
+    const uint32_t n_isls = static_cast<uint32_t>(isls.size());
+
+    // edges whose next communication depends on the orientation of a satellite
+    std::vector<std::vector<uint32_t>> incident_edges(instance.satelliteCount());
+    for (uint32_t i = 0; i < n_isls; i++) {
+        incident_edges[isls[i].getV1Idx()].push_back(i);
+        incident_edges[isls[i].getV2Idx()].push_back(i);
     }
 
-    // choose the best edge in each iteration.
-    while (remaining_edges.size() > 0) {
-        int best_edge_pos = 0;   // position in remaining edges
-        float t_next = INFINITY; // absolute time
+    // all edges are candidates at the beginning; they are evaluated in parallel (the cache is only read then)
+    completeCache();
+    std::vector<float> t_initial(n_isls);
+    ThreadPool pool(settings.threads);
+    const OrientationView orientations = orientationView();
+    pool.parallelFor(n_isls, [&](const size_t i) { t_initial[i] = nextCommunication(isls[i], 0.0f, orientations); });
 
-        // find the best edge depending on the time passed
-        for (size_t i = 0; i < remaining_edges.size(); i++) {
-            const InterSatelliteLink& e = *remaining_edges.at(i);
-            float next_communication = nextCommunication(e, curr_time);
+    // remaining edges by (next communication, isl index) - the lowest index wins ties like in a scan in index order
+    IndexedMinHeap<std::pair<float, uint32_t>> remaining_edges(n_isls);
+    for (uint32_t i = 0; i < n_isls; i++) {
+        if (t_initial[i] < INFINITY) {
+            remaining_edges.push(i, {t_initial[i], i});
+        }
+    }
 
-            // edge is avaible earlier
-            if (next_communication < t_next) {
-                t_next = next_communication;
-                best_edge_pos = i;
-            }
+    // The key of an edge stays valid until one of its satellites turns (see nextCommunication()). Then its key is
+    // lowered to the next visibility and the edge is marked as stale. Stale edges are evaluated when they reach the top
+    // of the heap - with the start time at which they got stale, so the result is the same as with a scan of all edges.
+    std::vector<bool> stale(n_isls, false);
+    std::vector<float> t_stale(n_isls, 0.f);
 
-            // it's not getting better
-            if (t_next - curr_time == 0.f)
-                break;
+    // choose the best edge in each iteration.
+    while (!remaining_edges.empty()) {
+        // fix stale keys until the best edge is up to date
+        while (stale[remaining_edges.top()]) {
+            uint32_t i = remaining_edges.top();
+            stale[i] = false;
+            remaining_edges.push(i, {nextCommunication(isls[i], t_stale[i], orientations), i});
         }
+        uint32_t edge_index = remaining_edges.top();
+        float t_next = remaining_edges.topKey().first; // absolute time
+        remaining_edges.pop();
 
         // refresh orientation of chosen satellites.
-        const InterSatelliteLink* e = remaining_edges.at(best_edge_pos);
+        const InterSatelliteLink* e = &isls[edge_index];
         glm::vec3 new_orientations = e->getOrientation(t_next);
-        satellite_orientation[&e->getV1()] = TimelineEvent<glm::vec3>(t_next, t_next, new_orientations);
-        satellite_orientation[&e->getV2()] = TimelineEvent<glm::vec3>(t_next, t_next, -new_orientations);
+        setOrientation(e->getV1Idx(), TimelineEvent<glm::vec3>(t_next, t_next, new_orientations));
+        setOrientation(e->getV2Idx(), TimelineEvent<glm::vec3>(t_next, t_next, -new_orientations));
 
-        // map position in remaining edges to position in all edges
-        std::ptrdiff_t edge_index = remaining_edges[best_edge_pos] - &instance.getISLs()[0];
         // add edge
-        scan_cover.insert({static_cast<uint32_t>(edge_index), t_next});
-        remaining_edges.erase(remaining_edges.begin() + best_edge_pos);
+        scan_cover.insert({edge_index, t_next});
         curr_time = t_next;
+
+        // the edges of both satellites have to be evaluated again
+        for (uint32_t satellite_idx : {e->getV1Idx(), e->getV2Idx()}) {
+            for (uint32_t i : incident_edges[satellite_idx]) {
+                if (remaining_edges.contains(i)) {
+                    stale[i] = true;
+                    t_stale[i] = curr_time;
+                    remaining_edges.push(i, {nextVisibility(isls[i], curr_time), i});
+                }
+            }
+        }
     }
 
     // end time for computation time
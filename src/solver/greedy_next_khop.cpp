@@ -1,5 +1,7 @@
 #include "dmsc/solver/greedy_next_khop.hpp"
+#include "thread_pool.hpp"
 #include <chrono>
+#include <cmath>
 #include <deque>
 #include <set>
 
@@ -25,7 +27,7 @@ DmscSolution GreedyNextKHop::solve() {
     // init variables
     ScanCover scan_cover;
     float curr_time = 0.0;
-    satellite_orientation.clear();
+    clearOrientations();
 
     // select edges for computation
     std::vector<Communication> remaining_communications;
@@ -40,70 +42,102 @@ DmscSolution GreedyNextKHop::solve() {
         }
     }
 
+    // candidates are the edges that continue the current paths of the remaining communications
+    struct Candidate {
+        uint32_t communication; // position in remaining communications
+        uint32_t neighbour;
+        const InterSatelliteLink* link;
+        float t_communication; // absolute time
+        bool memoized;
+    };
+    std::vector<Candidate> candidates;
+    std::vector<bool> path_possible; // is there at least one edge we can use? (will be visible in the future)
+
+    // only the edges on the paths of the scheduled communications are candidates
+    std::set<uint32_t> path_edges;
+    for (const Communication& com : remaining_communications) {
+        for (const auto& row : com.possible_paths.matrix) {
+            for (const auto& neighbour : row) {
+                path_edges.insert(neighbour.second.isl_idx);
+            }
+        }
+    }
+    completeCache(std::vector<uint32_t>(path_edges.begin(), path_edges.end()));
+    ThreadPool pool(settings.threads);
+
     // choose the best edge in each iteration
     while (remaining_communications.size() > 0) {
-        uint32_t chosen_communication = ~0u;
-        uint32_t chosen_neighbour = ~0u;
-        float t_next = INFINITY; // absolute time
-
-        // find the best edge depending on the time passed
+        candidates.clear();
         for (uint32_t i = 0; i < remaining_communications.size(); i++) {
             const Communication& com = remaining_communications[i];
-
-            std::map<uint32_t, AdjacencyList::Item> possible_neighbours = com.possible_paths[com.forward_idx];
             // iterate over all possibilities to continue the currently chosen path
-            bool path_possible = false; // is there at least one edge we can use? (will be visible in the future)
-            for (const auto& neighbour : possible_neighbours) {
-                const InterSatelliteLink& link = instance.getISLs()[neighbour.second.isl_idx];
-                float next_communication = nextCommunication(link, curr_time);
-
-                // will the edge become visible on the future?
-                if (next_communication < INFINITY) {
-                    path_possible = true;
-                }
-
-                // edge is avaible earlier
-                if (next_communication < t_next) {
-                    t_next = next_communication;
-                    chosen_neighbour = neighbour.first;
-                    chosen_communication = i;
-                }
-
-                // it's not getting better
-                if (t_next - curr_time == 0.f)
-                    break;
+            for (const auto& neighbour : com.possible_paths[com.forward_idx]) {
+                const InterSatelliteLink* link = &instance.getISLs()[neighbour.second.isl_idx];
+                candidates.push_back({i, neighbour.first, link, INFINITY, false});
             }
+        }
 
-            // we cant continue the current path
-            if (!path_possible) {
-                remaining_communications.erase(remaining_communications.begin() + i);
-                i--; // the size of the remaining communications just reduced by 1
+        // evaluate the candidates in parallel; the memo is only read here and updated afterwards
+        const OrientationView orientations = orientationView();
+        pool.parallelFor(candidates.size(), [&](const size_t j) {
+            Candidate& candidate = candidates[j];
+            candidate.t_communication = findMemoizedCommunication(*candidate.link, curr_time);
+            candidate.memoized = !std::isnan(candidate.t_communication);
+            if (!candidate.memoized) {
+                candidate.t_communication = nextCommunication(*candidate.link, curr_time, orientations);
+            }
+        });
+
+        // find the best edge: the earliest one and the first one in case of ties, so the result doesn't depend on the
+        // number of threads
+        const Candidate* chosen = nullptr;
+        path_possible.assign(remaining_communications.size(), false);
+        for (const Candidate& candidate : candidates) {
+            if (!candidate.memoized) {
+                memoizeCommunication(*candidate.link, curr_time, candidate.t_communication);
+            }
+            if (candidate.t_communication < INFINITY) {
+                path_possible[candidate.communication] = true;
+            }
+            if (candidate.t_communication < (chosen ? chosen->t_communication : INFINITY)) {
+                chosen = &candidate;
             }
         }
 
         // no "next" edge was found
-        if (chosen_communication == ~0u || chosen_neighbour == ~0u || t_next == INFINITY) {
+        if (chosen == nullptr) {
             break;
         }
+        float t_next = chosen->t_communication;
 
         // update communication
-        Communication& com = remaining_communications[chosen_communication];
-        uint32_t isl_idx = com.possible_paths[com.forward_idx][chosen_neighbour].isl_idx;
-        com.forward_idx = chosen_neighbour;
+        Communication& com = remaining_communications[chosen->communication];
+        uint32_t isl_idx = com.possible_paths[com.forward_idx][chosen->neighbour].isl_idx;
+        com.forward_idx = chosen->neighbour;
 
         // add edge to solution
         const InterSatelliteLink* isl = &instance.getISLs()[isl_idx];
         scan_cover.insert({isl_idx, t_next});
 
-        // if chosen communication is done now, remove it
+        // remove the chosen communication, if it is done now, and all communications we can't continue
         if (com.forward_idx == com.scheduled_communication.second) {
-            remaining_communications.erase(remaining_communications.begin() + chosen_communication);
+            path_possible[chosen->communication] = false;
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < remaining_communications.size(); i++) {
+            if (path_possible[i]) {
+                if (kept != i) {
+                    remaining_communications[kept] = std::move(remaining_communications[i]);
+                }
+                kept++;
+            }
         }
+        remaining_communications.resize(kept);
 
         // update satellite orientations
         glm::vec3 new_orientations = isl->getOrientation(t_next);
-        satellite_orientation[&isl->getV1()] = TimelineEvent<glm::vec3>(t_next, t_next, new_orientations);
-        satellite_orientation[&isl->getV2()] = TimelineEvent<glm::vec3>(t_next, t_next, -new_orientations);
+        setOrientation(isl->getV1Idx(), TimelineEvent<glm::vec3>(t_next, t_next, new_orientations));
+        setOrientation(isl->getV2Idx(), TimelineEvent<glm::vec3>(t_next, t_next, -new_orientations));
 
         // update time
         curr_time = t_next;
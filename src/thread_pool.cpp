@@ -0,0 +1,123 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+
+namespace dmsc {
+
+ThreadPool::ThreadPool(const size_t threads) {
+    size_t n = threads > 0 ? threads : std::max<size_t>(1, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < n; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 1; i < n; i++) {
+        workers.push_back(std::thread(&ThreadPool::work, this, i));
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void ThreadPool::parallelFor(const size_t n, const std::function<void(size_t)>& task) {
+    if (n == 0) {
+        return;
+    }
+    if (workers.empty()) {
+        for (size_t i = 0; i < n; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    // must be set before the first task can be taken
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        remaining = n;
+    }
+
+    // each thread starts with a contiguous range
+    for (size_t q = 0; q < queues.size(); q++) {
+        std::lock_guard<std::mutex> lock(queues[q]->mutex);
+        for (size_t i = q * n / queues.size(); i < (q + 1) * n / queues.size(); i++) {
+            queues[q]->tasks.push_back(i);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+    }
+    wake.notify_all();
+
+    while (runTask(0)) {
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return remaining == 0; });
+    this->task = nullptr;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void ThreadPool::work(const size_t self) {
+    size_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stop || generation != seen; });
+            if (stop) {
+                return;
+            }
+            seen = generation;
+        }
+
+        while (runTask(self)) {
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool ThreadPool::runTask(const size_t self) {
+    size_t idx = 0;
+    bool found = false;
+
+    // own queue from the back, other queues from the front
+    for (size_t k = 0; k < queues.size() && !found; k++) {
+        Queue& queue = *queues[(self + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            if (k == 0) {
+                idx = queue.tasks.back();
+                queue.tasks.pop_back();
+            } else {
+                idx = queue.tasks.front();
+                queue.tasks.pop_front();
+            }
+            found = true;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+
+    (*task)(idx);
+    if (--remaining == 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.notify_all();
+    }
+    return true;
+}
+
+} // namespace dmsc
@@ -0,0 +1,74 @@
+#ifndef DMSC_THREAD_POOL
+#define DMSC_THREAD_POOL
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dmsc {
+
+/**
+ * @brief Fixed set of threads that process the iterations of parallelFor().
+ *
+ * Every thread has its own queue and initially gets a contiguous range of the iterations. It takes tasks from the back
+ * of its own queue; if it runs out of tasks, it steals from the front of the other queues. So threads that got long
+ * tasks don't stall the others. The results should be written to a slot per iteration and merged afterwards, so they
+ * don't depend on the order in which the tasks were processed.
+ */
+class ThreadPool {
+  public:
+    /**
+     * @param threads number of threads including the thread that calls parallelFor() (0: one per hardware thread)
+     */
+    explicit ThreadPool(const size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Calls task(i) for all i in [0, n) and returns when all calls are finished. The calling thread processes
+     * tasks as well. Must not be called from within a task.
+     */
+    void parallelFor(const size_t n, const std::function<void(size_t)>& task);
+
+    /**
+     * @brief Returns the number of threads including the calling thread.
+     */
+    size_t size() const { return queues.size(); }
+
+  private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // one per thread; queue 0 belongs to the calling thread
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake; // new tasks or stop
+    std::condition_variable done; // all tasks finished
+    const std::function<void(size_t)>* task = nullptr;
+    std::atomic<size_t> remaining{0};
+    size_t generation = 0; // incremented with every parallelFor()
+    bool stop = false;
+
+    void work(const size_t self);
+
+    /**
+     * @brief Processes one task of the own queue or steals one from another queue.
+     * @return false, if all queues are empty
+     */
+    bool runTask(const size_t self);
+};
+
+} // namespace dmsc
+
+#endif
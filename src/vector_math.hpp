@@ -0,0 +1,122 @@
+#ifndef DMSC_VECTOR_MATH
+#define DMSC_VECTOR_MATH
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace dmsc {
+namespace math {
+
+constexpr double TWO_PI = 6.283185307179586476925;
+
+/**
+ * @brief Branch-free single precision sine and cosine (Cody-Waite range reduction and the minimax polynomials of the
+ * cephes library). In contrast to std::sin/std::cos, loops that call this function can be vectorized by the compiler.
+ * The absolute error is below 1e-6 for |x| < 1e4.
+ */
+inline void sincos(const float x, float& s, float& c) {
+    // reduce x to y in [-pi/4, pi/4] with x = y + k * pi/2
+    const float k = std::nearbyint(x * 0.63661977236758134308f); // 2/pi
+    float y = x - k * 1.5703125f;
+    y = y - k * 4.837512969970703125e-4f;
+    y = y - k * 7.54978995489188216e-8f;
+    const int32_t quadrant = static_cast<int32_t>(k) & 3;
+
+    const float z = y * y;
+    const float sin_y = y + y * z * (-1.6666654611e-1f + z * (8.3321608736e-3f + z * -1.9515295891e-4f));
+    const float cos_y =
+        1.f - .5f * z + z * z * (4.166664568298827e-2f + z * (-1.388731625493765e-3f + z * 2.443315711809948e-5f));
+
+    // rotate result into the correct quadrant
+    const bool swap = (quadrant & 1) != 0;
+    const float sign_sin = (quadrant & 2) != 0 ? -1.f : 1.f;
+    const float sign_cos = ((quadrant + 1) & 2) != 0 ? -1.f : 1.f;
+    s = sign_sin * (swap ? cos_y : sin_y);
+    c = sign_cos * (swap ? sin_y : cos_y);
+}
+
+/**
+ * @brief Reduces a phase angle to [0, 2pi). Computed in double precision, so that large time values do not destroy
+ * the phase.
+ */
+inline double wrapAngle(const double angle) { return angle - TWO_PI * std::floor(angle / TWO_PI); }
+
+/**
+ * @brief Searches the smallest common multiple T = a * p1 = b * p2 (a, b positive integers) of two periods, i.e. the
+ * time after which both periodic motions repeat together. The ratio p1 / p2 is approximated by the convergents b / a of
+ * its continued fraction; the first convergent whose error is within the tolerance has the smallest a of all fractions
+ * within the tolerance (best rational approximation).
+ * @param tolerance max. drift |a * p1 / p2 - b| of the second motion per common period (in periods)
+ * @param max_period only common periods up to this value are considered
+ * @return T or INFINITY, if there is no such common period
+ */
+inline double findHyperperiod(const double p1, const double p2, const double tolerance, const double max_period) {
+    const double ratio = p1 / p2;
+    double x = ratio;
+    double a_prev = 0.0, a = 1.0; // denominators of the last two convergents
+    double b_prev = 1.0, b = std::floor(x);
+    while (a * p1 <= max_period) {
+        if (std::abs(a * ratio - b) <= tolerance) {
+            return a * p1;
+        }
+
+        // next term of the continued fraction
+        double fraction = x - std::floor(x);
+        if (fraction == 0.0) {
+            break;
+        }
+        x = 1.0 / fraction;
+        double term = std::floor(x);
+        double a_next = term * a + a_prev;
+        double b_next = term * b + b_prev;
+        a_prev = a;
+        b_prev = b;
+        a = a_next;
+        b = b_next;
+    }
+    return INFINITY;
+}
+
+/**
+ * @brief Returns the index of the lowest set bit. x must not be 0.
+ */
+inline uint32_t countTrailingZeros(const uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return static_cast<uint32_t>(idx);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(x));
+#endif
+}
+
+/**
+ * @brief Returns the index of the first set bit >= bit in an array of words (bit i is bit i % 64 of word i / 64). The
+ * words are skipped as long as they are 0, so a scan costs one countTrailingZeros() per call.
+ * @param flip the words are xor-ed with this value (~0: search the first clear bit instead)
+ * @return 64 * n_words, if there is no such bit
+ */
+inline size_t findNextSetBit(const uint64_t* words, const size_t n_words, const size_t bit, const uint64_t flip = 0) {
+    size_t word_idx = bit / 64;
+    if (word_idx >= n_words) {
+        return 64 * n_words;
+    }
+
+    uint64_t word = (words[word_idx] ^ flip) & (~uint64_t(0) << (bit % 64)); // ignore the bits before bit
+    while (word == 0) {
+        if (++word_idx == n_words) {
+            return 64 * n_words;
+        }
+        word = words[word_idx] ^ flip;
+    }
+    return 64 * word_idx + countTrailingZeros(word);
+}
+
+} // namespace math
+} // namespace dmsc
+
+#endif
@@ -0,0 +1,130 @@
+#include "visibility_cache_file.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DMSC_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dmsc {
+
+constexpr char VisibilityCacheFile::MAGIC[8];
+
+VisibilityCacheFile::VisibilityCacheFile(const std::string& file, const uint64_t fingerprint) {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+
+#ifdef DMSC_USE_MMAP
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(Header))) {
+        void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            mapping = mapped;
+            mapping_size = static_cast<size_t>(info.st_size);
+            data = static_cast<const unsigned char*>(mapped);
+            size = mapping_size;
+        }
+    }
+    close(fd);
+#else
+    std::ifstream in(file, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        return;
+    }
+    size = static_cast<size_t>(in.tellg());
+    buffer.resize((size + sizeof(uint64_t) - 1) / sizeof(uint64_t)); // aligned for the windows
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size));
+    data = reinterpret_cast<const unsigned char*>(buffer.data());
+#endif
+
+    // check header and size
+    if (data == nullptr || size < sizeof(Header)) {
+        return;
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.fingerprint != fingerprint) {
+        return;
+    }
+    size_t expected_size =
+        sizeof(Header) + (header.edge_count + 1) * sizeof(uint64_t) + header.window_count * sizeof(Window);
+    if (size != expected_size) {
+        return;
+    }
+
+    edge_count = header.edge_count;
+    offsets = reinterpret_cast<const uint64_t*>(data + sizeof(Header));
+    windows = reinterpret_cast<const Window*>(data + sizeof(Header) + (edge_count + 1) * sizeof(uint64_t));
+    if (offsets[edge_count] != header.window_count) {
+        offsets = nullptr;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+VisibilityCacheFile::~VisibilityCacheFile() {
+#ifdef DMSC_USE_MMAP
+    if (mapping != nullptr) {
+        munmap(mapping, mapping_size);
+    }
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool VisibilityCacheFile::save(const std::string& file, const uint64_t fingerprint,
+                               const std::vector<const std::vector<Window>*>& windows) {
+    std::vector<uint64_t> offsets = {0};
+    std::vector<Window> data;
+    for (const std::vector<Window>* row : windows) {
+        data.insert(data.end(), row->begin(), row->end());
+        offsets.push_back(data.size());
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.reserved = 0;
+    header.fingerprint = fingerprint;
+    header.edge_count = windows.size();
+    header.window_count = data.size();
+
+    std::string tmp_file = file + ".tmp";
+    {
+        std::ofstream out(tmp_file, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+        out.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(Window));
+        out.close();
+        if (out.fail()) {
+            std::remove(tmp_file.c_str());
+            return false;
+        }
+    }
+
+    // replace the old file
+    if (std::rename(tmp_file.c_str(), file.c_str()) != 0) {
+        std::remove(file.c_str());
+        if (std::rename(tmp_file.c_str(), file.c_str()) != 0) {
+            std::remove(tmp_file.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace dmsc
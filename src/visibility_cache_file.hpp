@@ -0,0 +1,99 @@
+#ifndef DMSC_VISIBILITY_CACHE_FILE
+#define DMSC_VISIBILITY_CACHE_FILE
+
+#include "dmsc/tick.hpp"
+#include "dmsc/timeline.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dmsc {
+
+/**
+ * @brief 64 bit FNV-1a hash that identifies the input of a computation (e.g. an instance and the solver settings).
+ */
+class Fingerprint {
+  public:
+    /**
+     * @brief Adds the bytes of a value (must be a trivially copyable type without padding).
+     */
+    template <typename T>
+    void add(const T& value) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        for (size_t i = 0; i < sizeof(T); i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    }
+
+    uint64_t value() const { return hash; }
+
+  private:
+    uint64_t hash = 14695981039346656037ull;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Binary file that stores the visibility windows of several edges. The windows are stored as compressed rows:
+ * the windows of edge i are [offsets[i], offsets[i + 1]) in one array of (begin, end) pairs. The file is memory mapped
+ * (or read at once, if mmap isn't available) and used without parsing.
+ *
+ * Layout: header | uint64_t offsets[edge_count + 1] | Window windows[window_count]
+ */
+class VisibilityCacheFile {
+  public:
+    using Window = TimeWindow;
+
+    /**
+     * @brief Opens the given file. The file is only used, if it has been created for the given fingerprint (see
+     * isValid()).
+     */
+    VisibilityCacheFile(const std::string& file, const uint64_t fingerprint);
+    ~VisibilityCacheFile();
+
+    VisibilityCacheFile(const VisibilityCacheFile&) = delete;
+    VisibilityCacheFile& operator=(const VisibilityCacheFile&) = delete;
+
+    /**
+     * @brief Writes the windows of all edges into the given file. The file is written under a temporary name and
+     * renamed afterwards, so readers never see a partial file.
+     * @return false, if the file could not be written
+     */
+    static bool save(const std::string& file, const uint64_t fingerprint,
+                     const std::vector<const std::vector<Window>*>& windows);
+
+    /**
+     * @brief Returns true, if the file exists, is complete and matches the fingerprint.
+     */
+    bool isValid() const { return offsets != nullptr; }
+
+    size_t edgeCount() const { return edge_count; }
+    const Window* begin(const size_t edge) const { return windows + offsets[edge]; }
+    const Window* end(const size_t edge) const { return windows + offsets[edge + 1]; }
+
+  private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t fingerprint;
+        uint64_t edge_count;
+        uint64_t window_count;
+    };
+
+    static constexpr char MAGIC[8] = {'D', 'M', 'S', 'C', 'V', 'I', 'S', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    // memory of the file (either mapped or read into buffer)
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+    std::vector<uint64_t> buffer;
+
+    size_t edge_count = 0;
+    const uint64_t* offsets = nullptr;
+    const Window* windows = nullptr;
+};
+
+} // namespace dmsc
+
+#endif